@@ -0,0 +1,29 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "CellQueue.h"
+
+CellQueue::CellQueue() {
+  clear();
+}
+
+void CellQueue::clear() {
+  mHead = 0;
+  mTail = 0;
+}
+
+boolean CellQueue::isEmpty() {
+  return mHead == mTail;
+}
+
+void CellQueue::push(uint8_t x, uint8_t y) {
+  if (mTail >= CELL_COUNT) {
+    return;
+  }
+  mCells[mTail++] = (uint16_t)x << 8 | y;
+}
+
+void CellQueue::pop(uint8_t& x, uint8_t& y) {
+  uint16_t cell = mCells[mHead++];
+  x = cell >> 8;
+  y = cell & 0xff;
+}
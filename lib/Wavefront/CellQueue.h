@@ -0,0 +1,49 @@
+#ifndef _CellQueue_h_
+#define _CellQueue_h_
+
+/**
+ * A first-in first-out queue of grid cells, used as the frontier of the
+ * breadth-first planning engines. Each cell may be pushed at most once
+ * between calls to CellQueue::clear(), which is all a breadth-first
+ * search ever needs, so the storage never has to wrap around.
+ */
+class CellQueue {
+
+  public:
+
+    /**
+     * Constructs an empty queue large enough for every cell of a
+     * DEFAULT_X_SIZE x DEFAULT_Y_SIZE map.
+     */
+    CellQueue();
+
+    /**
+     * Empties the queue.
+     */
+    void clear();
+
+    /**
+     * Returns true if there are no cells left to pop.
+     */
+    boolean isEmpty();
+
+    /**
+     * Appends a cell to the end of the queue. Pushes beyond CELL_COUNT
+     * cells are ignored.
+     */
+    void push(uint8_t x, uint8_t y);
+
+    /**
+     * Removes the cell at the front of the queue. Must not be called on
+     * an empty queue.
+     */
+    void pop(uint8_t& x, uint8_t& y);
+
+  private:
+
+    uint16_t mHead;
+    uint16_t mTail;
+    uint16_t mCells[CELL_COUNT];
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "CellSet.h"
+
+CellSet::CellSet() {
+  clear();
+}
+
+void CellSet::clear() {
+  for (uint16_t i=0; i<sizeof(mBits); i++) {
+    mBits[i] = 0;
+  }
+}
+
+void CellSet::add(uint8_t x, uint8_t y) {
+  if (x >= DEFAULT_X_SIZE || y >= DEFAULT_Y_SIZE) {
+    return;
+  }
+  uint16_t cell = (uint16_t)x * DEFAULT_Y_SIZE + y;
+  mBits[cell >> 3] |= 1 << (cell & 7);
+}
+
+void CellSet::remove(uint8_t x, uint8_t y) {
+  if (x >= DEFAULT_X_SIZE || y >= DEFAULT_Y_SIZE) {
+    return;
+  }
+  uint16_t cell = (uint16_t)x * DEFAULT_Y_SIZE + y;
+  mBits[cell >> 3] &= ~(1 << (cell & 7));
+}
+
+boolean CellSet::contains(uint8_t x, uint8_t y) {
+  if (x >= DEFAULT_X_SIZE || y >= DEFAULT_Y_SIZE) {
+    return false;
+  }
+  uint16_t cell = (uint16_t)x * DEFAULT_Y_SIZE + y;
+  return (mBits[cell >> 3] >> (cell & 7)) & 1;
+}
@@ -0,0 +1,36 @@
+#ifndef _CellSet_h_
+#define _CellSet_h_
+
+/**
+ * A set of grid cells kept as one bit per cell, so membership tests are
+ * constant time and a whole 10x10 map costs 13 bytes.
+ */
+class CellSet {
+
+  public:
+
+    /**
+     * Constructs an empty set.
+     */
+    CellSet();
+
+    /**
+     * Removes every cell from the set.
+     */
+    void clear();
+
+    void add(uint8_t x, uint8_t y);
+    void remove(uint8_t x, uint8_t y);
+
+    /**
+     * Returns true if the cell is in the set. Cells off the grid never
+     * are.
+     */
+    boolean contains(uint8_t x, uint8_t y);
+
+  private:
+
+    uint8_t mBits[(CELL_COUNT + 7) / 8];
+};
+
+#endif
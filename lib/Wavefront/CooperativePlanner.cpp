@@ -0,0 +1,267 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "DistanceField.h"
+#include "SpaceTimeTable.h"
+#include "PlanArena.h"
+#include "CooperativePlanner.h"
+
+/*
+ * Marks an empty entry of the seen hash and the parent of the start.
+ */
+#define NO_NODE 0xffff
+
+static const int8_t STEP_X[] = { 0, -1, 0, 1, 0, 0 };
+static const int8_t STEP_Y[] = { 0, 0, 1, 0, -1, 0 };
+
+CooperativePlanner::CooperativePlanner(PlanArena& arena) {
+  mMap = NULL;
+  mField = NULL;
+  mTable = NULL;
+  mArena = &arena;
+  mNodes = NULL;
+  mSeen = NULL;
+  mHeap = NULL;
+  mRobot = NO_ROBOT;
+  mNodeCount = 0;
+  mHeapCount = 0;
+  mExpanded = 0;
+  mFull = false;
+  mLength = 0;
+}
+
+boolean CooperativePlanner::plan(Map& map,
+                                 DistanceField& field,
+                                 SpaceTimeTable& table,
+                                 uint8_t robot,
+                                 uint8_t startX,
+                                 uint8_t startY) {
+  mMap = &map;
+  mField = &field;
+  mTable = &table;
+  mRobot = robot;
+  mNodeCount = 0;
+  mHeapCount = 0;
+  mExpanded = 0;
+  mFull = false;
+  mLength = 0;
+
+  uint32_t top = mArena->mark();
+  mNodes = (CooperativeNode *)mArena->take(COOPERATIVE_NODES * sizeof(CooperativeNode));
+  mSeen = (uint16_t *)mArena->take(COOPERATIVE_NODES * 2 * sizeof(uint16_t));
+  mHeap = (uint16_t *)mArena->take(COOPERATIVE_NODES * sizeof(uint16_t));
+
+  boolean found = false;
+  if (mNodes == NULL || mSeen == NULL || mHeap == NULL) {
+    mFull = true;
+  } else {
+    found = search(startX, startY);
+  }
+
+  mArena->release(top);
+  mNodes = NULL;
+  mSeen = NULL;
+  mHeap = NULL;
+  return found;
+}
+
+/*
+ * The search itself, in the nodes just taken from the arena.
+ */
+boolean CooperativePlanner::search(uint8_t startX, uint8_t startY) {
+  for (uint16_t i=0; i<COOPERATIVE_NODES * 2; i++) {
+    mSeen[i] = NO_NODE;
+  }
+
+  uint8_t goalX = mField->getGoalX();
+  uint8_t goalY = mField->getGoalY();
+  uint8_t value = mField->getValue(startX, startY);
+  if (value == NOTHING || value == WALL || value == UNKNOWN || ! canStay(startX, startY, 0)) {
+    return false;
+  }
+
+  // Someone else parked on the goal can never be waited out
+  uint8_t parked = mTable->owner(goalX, goalY, SPACE_TIME_PARKED - 1);
+  if (parked != NO_ROBOT && parked != mRobot) {
+    return false;
+  }
+
+  addNode(startX, startY, 0, NO_NODE);
+  while (mHeapCount > 0) {
+    uint16_t index = pop();
+    CooperativeNode node = mNodes[index];
+
+    if (node.x == goalX && node.y == goalY) {
+      // Only stop where nobody comes through later on
+      boolean clear = true;
+      for (uint16_t t=node.time+1; t<=mTable->getLastTime() && clear; t++) {
+        clear = canStay(goalX, goalY, t);
+      }
+      if (clear) {
+        if (! mTable->hasRoom(node.time + 2)) {
+          return false;
+        }
+        commit(index, startX, startY);
+        return true;
+      }
+    }
+
+    if (node.time + 1 >= COOPERATIVE_MAX_STEPS) {
+      continue;
+    }
+    mExpanded++;
+
+    for (uint8_t move=UP; move<=WAIT; move++) {
+      uint8_t x = node.x + STEP_X[move];
+      uint8_t y = node.y + STEP_Y[move];
+      uint8_t next = mField->getValue(x, y);
+      if (next == NOTHING || next == WALL || next == UNKNOWN) {
+        continue;
+      }
+      if (move == WAIT ? canStay(x, y, node.time + 1)
+                       : canMove(node.x, node.y, x, y, node.time + 1)) {
+        addNode(x, y, node.time + 1, index);
+      }
+    }
+  }
+  return false;
+}
+
+boolean CooperativePlanner::canStay(uint8_t x, uint8_t y, uint16_t time) {
+  uint8_t owner = mTable->owner(x, y, time);
+  return owner == NO_ROBOT || owner == mRobot;
+}
+
+/*
+ * Moving into a cell needs it free on arrival, and must not swap places
+ * with a robot coming the other way.
+ */
+boolean CooperativePlanner::canMove(uint8_t fromX,
+                                    uint8_t fromY,
+                                    uint8_t toX,
+                                    uint8_t toY,
+                                    uint16_t time) {
+  if (! canStay(toX, toY, time)) {
+    return false;
+  }
+  uint8_t coming = mTable->owner(toX, toY, time - 1);
+  return coming == NO_ROBOT || coming == mRobot || mTable->owner(fromX, fromY, time) != coming;
+}
+
+/*
+ * Every path to a (cell, step) state costs the same number of steps, so
+ * a state seen once never needs to be looked at again.
+ */
+void CooperativePlanner::addNode(uint8_t x, uint8_t y, uint16_t time, uint16_t parent) {
+  uint32_t hash = ((uint32_t)x << 8 | y) * 0x9e3779b1UL ^ (uint32_t)time * 0x85ebca77UL;
+  hash ^= hash >> 16;
+  uint16_t slot = hash & (COOPERATIVE_NODES * 2 - 1);
+  while (mSeen[slot] != NO_NODE) {
+    CooperativeNode& seen = mNodes[mSeen[slot]];
+    if (seen.x == x && seen.y == y && seen.time == time) {
+      return;
+    }
+    slot = (slot + 1) & (COOPERATIVE_NODES * 2 - 1);
+  }
+
+  if (mNodeCount == COOPERATIVE_NODES) {
+    mFull = true;
+    return;
+  }
+
+  uint16_t index = mNodeCount++;
+  CooperativeNode& node = mNodes[index];
+  node.x = x;
+  node.y = y;
+  node.time = time;
+  node.cost = time + mField->getValue(x, y) - GOAL;
+  node.parent = parent;
+  mSeen[slot] = index;
+  push(index);
+}
+
+/*
+ * The open list is a binary heap ordered by cost, the later step first
+ * among equal costs so that the search dives towards the goal.
+ */
+boolean CooperativePlanner::before(uint16_t a, uint16_t b) {
+  if (mNodes[a].cost != mNodes[b].cost) {
+    return mNodes[a].cost < mNodes[b].cost;
+  }
+  return mNodes[a].time > mNodes[b].time;
+}
+
+void CooperativePlanner::push(uint16_t index) {
+  uint16_t child = mHeapCount++;
+  while (child > 0) {
+    uint16_t parent = (child - 1) / 2;
+    if (! before(index, mHeap[parent])) {
+      break;
+    }
+    mHeap[child] = mHeap[parent];
+    child = parent;
+  }
+  mHeap[child] = index;
+}
+
+uint16_t CooperativePlanner::pop() {
+  uint16_t top = mHeap[0];
+  uint16_t last = mHeap[--mHeapCount];
+
+  uint16_t parent = 0;
+  for (;;) {
+    uint16_t child = parent * 2 + 1;
+    if (child >= mHeapCount) {
+      break;
+    }
+    if (child + 1 < mHeapCount && before(mHeap[child + 1], mHeap[child])) {
+      child++;
+    }
+    if (! before(mHeap[child], last)) {
+      break;
+    }
+    mHeap[parent] = mHeap[child];
+    parent = child;
+  }
+  mHeap[parent] = last;
+  return top;
+}
+
+/*
+ * Writes the moves from the start to the final node and holds every
+ * (cell, step) along them, and the goal from then on, in the table.
+ */
+void CooperativePlanner::commit(uint16_t index, uint8_t startX, uint8_t startY) {
+  CooperativeNode& last = mNodes[index];
+  mLength = last.time;
+  mTable->park(last.x, last.y, last.time, mRobot);
+
+  while (mNodes[index].parent != NO_NODE) {
+    CooperativeNode& node = mNodes[index];
+    CooperativeNode& parent = mNodes[node.parent];
+
+    uint8_t move = UP;
+    while (parent.x + STEP_X[move] != node.x || parent.y + STEP_Y[move] != node.y) {
+      move++;
+    }
+    mMoves[parent.time] = move;
+    mTable->reserve(node.x, node.y, node.time, mRobot);
+    index = node.parent;
+  }
+  mTable->reserve(startX, startY, 0, mRobot);
+}
+
+uint16_t CooperativePlanner::getLength() {
+  return mLength;
+}
+
+uint8_t CooperativePlanner::getMove(uint16_t i) {
+  return i < mLength ? mMoves[i] : NOTHING;
+}
+
+uint16_t CooperativePlanner::getExpanded() {
+  return mExpanded;
+}
+
+boolean CooperativePlanner::getExhausted() {
+  return mFull;
+}
@@ -0,0 +1,134 @@
+#ifndef _CooperativePlanner_h_
+#define _CooperativePlanner_h_
+
+/**
+ * The number of search nodes a CooperativePlanner can hold. Must be a
+ * power of two, at most 16384.
+ */
+#ifndef COOPERATIVE_NODES
+#define COOPERATIVE_NODES 128
+#endif
+
+/**
+ * The longest plan, waits included, a CooperativePlanner searches for.
+ */
+#ifndef COOPERATIVE_MAX_STEPS
+#define COOPERATIVE_MAX_STEPS 64
+#endif
+
+class Map;
+
+class DistanceField;
+
+class SpaceTimeTable;
+
+class PlanArena;
+
+/**
+ * One (grid cell, step) state reached by the search.
+ */
+struct CooperativeNode {
+  uint8_t x;
+  uint8_t y;
+  uint16_t time;
+  uint16_t cost;
+  uint16_t parent;
+};
+
+/**
+ * The most PlanArena bytes CooperativePlanner::plan() takes (see
+ * PlanArena.h).
+ */
+#define COOPERATIVE_ARENA (PLAN_ARENA_SPACE(COOPERATIVE_NODES * sizeof(CooperativeNode)) + \
+                           PLAN_ARENA_SPACE(COOPERATIVE_NODES * 2 * sizeof(uint16_t)) + \
+                           PLAN_ARENA_SPACE(COOPERATIVE_NODES * sizeof(uint16_t)))
+
+/**
+ * Prioritized cooperative A* for a fleet of robots on one floor plan.
+ * Robots are planned one at a time, in priority order, each through
+ * space-time (grid cell, step) states around the cells the robots
+ * planned before it hold in a shared SpaceTimeTable, then its own path
+ * is committed to the table for the robots after it. Each step a robot
+ * moves UP, RIGHT, DOWN or LEFT, or WAITs, and never enters a cell held
+ * at that step or swaps cells with another robot. Once at its goal a
+ * robot parks there for good.
+ *
+ * The distance field to the robot's goal over the static map is the
+ * heuristic, so with no one else around the search goes straight down
+ * the field.
+ */
+class CooperativePlanner {
+
+  public:
+
+    /**
+     * Constructs a planner with no plan that searches in memory taken
+     * from the arena, given back before each plan() returns.
+     */
+    CooperativePlanner(PlanArena& arena);
+
+    /**
+     * Plans the robot from its start to the goal of the field, which
+     * must be computed over the same map, around the table. On success
+     * the path, and the robot parking at the goal, are committed to the
+     * table. Returns false, committing nothing, if there is no way
+     * within COOPERATIVE_MAX_STEPS steps, if the search ran out of nodes
+     * or arena, or if the table has no room for the path.
+     */
+    boolean plan(Map& map,
+                 DistanceField& field,
+                 SpaceTimeTable& table,
+                 uint8_t robot,
+                 uint8_t startX,
+                 uint8_t startY);
+
+    /**
+     * Gets the number of steps, waits included, of the last plan.
+     */
+    uint16_t getLength();
+
+    /**
+     * Gets move i of the last plan (a direction or WAIT), or NOTHING past
+     * its end.
+     */
+    uint8_t getMove(uint16_t i);
+
+    /**
+     * Gets the number of nodes the last plan expanded.
+     */
+    uint16_t getExpanded();
+
+    /**
+     * Returns true if the last plan ran out of nodes, or the arena could
+     * not hold them.
+     */
+    boolean getExhausted();
+
+  private:
+
+    boolean search(uint8_t startX, uint8_t startY);
+    boolean canStay(uint8_t x, uint8_t y, uint16_t time);
+    boolean canMove(uint8_t fromX, uint8_t fromY, uint8_t toX, uint8_t toY, uint16_t time);
+    void addNode(uint8_t x, uint8_t y, uint16_t time, uint16_t parent);
+    void push(uint16_t index);
+    uint16_t pop();
+    boolean before(uint16_t a, uint16_t b);
+    void commit(uint16_t index, uint8_t startX, uint8_t startY);
+
+    Map *mMap;
+    DistanceField *mField;
+    SpaceTimeTable *mTable;
+    PlanArena *mArena;
+    uint8_t mRobot;
+    CooperativeNode *mNodes;
+    uint16_t *mSeen;
+    uint16_t *mHeap;
+    uint16_t mNodeCount;
+    uint16_t mHeapCount;
+    uint16_t mExpanded;
+    boolean mFull;
+    uint8_t mMoves[COOPERATIVE_MAX_STEPS];
+    uint16_t mLength;
+};
+
+#endif
@@ -0,0 +1,383 @@
+#include <Arduino.h>
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "FloorPlan.h"
+#include "DistanceField.h"
+
+DistanceField::DistanceField() {
+  mSizeX = 0;
+  mSizeY = 0;
+  mGoalX = 0xff;
+  mGoalY = 0xff;
+  mStop = 0xffff;
+}
+
+/*
+ * Returned by DistanceField::propagate() when no frontier was found.
+ */
+#define NO_CELL 0xffff
+
+/*
+ * The budget of a wave that runs to completion.
+ */
+#define NO_BUDGET 0xffffffffUL
+
+void DistanceField::compute(Map& map, uint8_t goalX, uint8_t goalY, CellQueue& queue) {
+  propagate(map, goalX, goalY, queue, false, NO_CELL, NO_BUDGET);
+}
+
+void DistanceField::compute(FloorPlan& plan, CellSet& overlay, uint8_t goalX, uint8_t goalY) {
+  if (plan.getSizeX() > DEFAULT_X_SIZE || plan.getSizeY() > DEFAULT_Y_SIZE) {
+    mSizeX = 0;
+    mSizeY = 0;
+    mGoalX = goalX;
+    mGoalY = goalY;
+    return;
+  }
+
+  mSizeX = plan.getSizeX();
+  mSizeY = plan.getSizeY();
+  for (uint8_t x=0; x<mSizeX; x++) {
+    for (uint8_t y=0; y<mSizeY; y++) {
+      mField[layoutIndex(x, y)] = plan.isWall(x, y) || overlay.contains(x, y) ? WALL : NOTHING;
+    }
+  }
+
+  spreadOver(plan, goalX, goalY);
+}
+
+boolean DistanceField::computeUntil(Map& map,
+                                    uint8_t goalX,
+                                    uint8_t goalY,
+                                    CellQueue& queue,
+                                    uint8_t stopX,
+                                    uint8_t stopY) {
+  uint16_t stop = (uint16_t)stopX << 8 | stopY;
+  return propagate(map, goalX, goalY, queue, false, stop, NO_BUDGET) == stop;
+}
+
+uint8_t DistanceField::nearestFrontier(Map& map,
+                                       uint8_t robotX,
+                                       uint8_t robotY,
+                                       CellQueue& queue,
+                                       Coordinate& frontier) {
+  uint16_t found = propagate(map, robotX, robotY, queue, true, NO_CELL, NO_BUDGET);
+  if (found == NO_CELL) {
+    frontier.setCoordinates(0xff, 0xff);
+    return NOTHING;
+  }
+
+  uint8_t x = found >> 8;
+  uint8_t y = found & 0xff;
+  frontier.setCoordinates(x, y);
+
+  // Walk back down the wave to the cell next to the robot; the way
+  // back from there is the robot's first step.
+  uint8_t direction = NOTHING;
+  while (mField[layoutIndex(x, y)] > GOAL) {
+    direction = directionFrom(x, y);
+    switch (direction) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+    }
+  }
+
+  switch (direction) {
+    case DOWN: return UP;
+    case UP: return DOWN;
+    case RIGHT: return LEFT;
+    case LEFT: return RIGHT;
+  }
+  return NOTHING;
+}
+
+void DistanceField::fill(uint8_t sizeX, uint8_t sizeY, uint8_t value) {
+  mSizeX = sizeX;
+  mSizeY = sizeY;
+
+  // Every layout numbers the far corner of the grid last
+  if (sizeX > 0 && sizeY > 0) {
+    memset(mField, value, layoutIndex(sizeX - 1, sizeY - 1) + 1);
+  }
+}
+
+void DistanceField::placeValue(uint8_t x, uint8_t y, uint8_t value) {
+  if (x < mSizeX && y < mSizeY) {
+    mField[layoutIndex(x, y)] = value;
+  }
+}
+
+boolean DistanceField::spreadUntil(uint8_t goalX,
+                                   uint8_t goalY,
+                                   CellQueue& queue,
+                                   uint8_t stopX,
+                                   uint8_t stopY) {
+  uint16_t stop = (uint16_t)stopX << 8 | stopY;
+  return spread(goalX, goalY, queue, false, stop, NO_BUDGET) == stop;
+}
+
+void DistanceField::begin(Map& map,
+                          uint8_t goalX,
+                          uint8_t goalY,
+                          CellQueue& queue,
+                          uint8_t stopX,
+                          uint8_t stopY) {
+  mStop = (uint16_t)stopX << 8 | stopY;
+  propagate(map, goalX, goalY, queue, false, mStop, 0);
+}
+
+boolean DistanceField::resume(CellQueue& queue, uint16_t budget) {
+  if (wave(queue, false, mStop, budget) == mStop) {
+    queue.clear();
+  }
+  return queue.isEmpty();
+}
+
+/*
+ * Copies the map's blocked cells into the field and runs the wave.
+ */
+uint16_t DistanceField::propagate(Map& map,
+                                  uint8_t fromX,
+                                  uint8_t fromY,
+                                  CellQueue& queue,
+                                  boolean toFrontier,
+                                  uint16_t stop,
+                                  uint32_t budget) {
+  mSizeX = map.getSizeX();
+  mSizeY = map.getSizeY();
+
+  for (uint8_t x=0; x<mSizeX; x++) {
+    for (uint8_t y=0; y<mSizeY; y++) {
+      uint8_t value = map.getValue(x, y);
+      mField[layoutIndex(x, y)] = (value == WALL || value == UNKNOWN) ? value : NOTHING;
+    }
+  }
+
+  return spread(fromX, fromY, queue, toFrontier, stop, budget);
+}
+
+/*
+ * Seeds the breadth-first wave behind every public entry point and runs
+ * it for at most budget cells.
+ */
+uint16_t DistanceField::spread(uint8_t fromX,
+                               uint8_t fromY,
+                               CellQueue& queue,
+                               boolean toFrontier,
+                               uint16_t stop,
+                               uint32_t budget) {
+  mGoalX = fromX;
+  mGoalY = fromY;
+  queue.clear();
+
+  if (fromX >= mSizeX || fromY >= mSizeY || mField[layoutIndex(fromX, fromY)] != NOTHING) {
+    return NO_CELL;
+  }
+
+  mField[layoutIndex(fromX, fromY)] = GOAL;
+  queue.push(fromX, fromY);
+
+  return wave(queue, toFrontier, stop, budget);
+}
+
+/*
+ * Settles at most budget cells off the queue. It stops early, returning
+ * the cell packed as x << 8 | y, when it settles the stop cell or, when
+ * looking for a frontier, the first cell that borders an UNKNOWN one.
+ * Otherwise it returns NO_CELL, both when the queue runs dry and when
+ * the budget does; the queue tells the two apart.
+ */
+uint16_t DistanceField::wave(CellQueue& queue, boolean toFrontier, uint16_t stop, uint32_t budget) {
+  while (budget-- && ! queue.isEmpty()) {
+    uint8_t x;
+    uint8_t y;
+    queue.pop(x, y);
+
+    uint16_t index = layoutIndex(x, y);
+    uint16_t packed = (uint16_t)x << 8 | y;
+    if (packed == stop || (toFrontier && bordersUnknown(x, y))) {
+      return packed;
+    }
+
+    uint8_t next = mField[index] + 1;
+    if (next >= RESET_MIN) {
+      continue;
+    }
+
+    // Unsigned wrap-around takes care of x - 1 and y - 1 at the edges
+    if (x + 1 < mSizeX) {
+      uint8_t& cell = mField[layoutStepDown(index, x)];
+      if (cell == NOTHING) {
+        cell = next;
+        queue.push(x + 1, y);
+      }
+    }
+    if ((uint8_t)(x - 1) < mSizeX) {
+      uint8_t& cell = mField[layoutStepUp(index, x)];
+      if (cell == NOTHING) {
+        cell = next;
+        queue.push(x - 1, y);
+      }
+    }
+    if (y + 1 < mSizeY) {
+      uint8_t& cell = mField[layoutStepRight(index, y)];
+      if (cell == NOTHING) {
+        cell = next;
+        queue.push(x, y + 1);
+      }
+    }
+    if ((uint8_t)(y - 1) < mSizeY) {
+      uint8_t& cell = mField[layoutStepLeft(index, y)];
+      if (cell == NOTHING) {
+        cell = next;
+        queue.push(x, y - 1);
+      }
+    }
+  }
+
+  return NO_CELL;
+}
+
+/*
+ * The wave of spread(), stepping only where the plan's neighbour mask
+ * allows; the overlay's walls are in the field already.
+ */
+/*
+ * Labels the field a level at a time, in place, without a queue: each
+ * sweep gives every open neighbour of a cell of the current level the
+ * next one. Cells labelled during a sweep hold the next level, so they
+ * are not spread from until the sweep after, and each cell's label is
+ * its distance from the goal, just as a breadth-first wave would give.
+ * That costs a pass over the field per level, but no RAM beyond it.
+ */
+void DistanceField::spreadOver(FloorPlan& plan, uint8_t fromX, uint8_t fromY) {
+  mGoalX = fromX;
+  mGoalY = fromY;
+
+  if (fromX >= mSizeX || fromY >= mSizeY || mField[layoutIndex(fromX, fromY)] != NOTHING) {
+    return;
+  }
+  mField[layoutIndex(fromX, fromY)] = GOAL;
+
+  boolean changed = true;
+  for (uint8_t level=GOAL; changed && level+1<RESET_MIN; level++) {
+    uint8_t next = level + 1;
+    changed = false;
+
+    for (uint8_t x=0; x<mSizeX; x++) {
+      for (uint8_t y=0; y<mSizeY; y++) {
+        uint16_t index = layoutIndex(x, y);
+        if (mField[index] != level) {
+          continue;
+        }
+
+        uint8_t neighbours = plan.getNeighbours(x, y);
+        if (neighbours & (1 << (DOWN - 1))) {
+          uint8_t& cell = mField[layoutStepDown(index, x)];
+          if (cell == NOTHING) {
+            cell = next;
+            changed = true;
+          }
+        }
+        if (neighbours & (1 << (UP - 1))) {
+          uint8_t& cell = mField[layoutStepUp(index, x)];
+          if (cell == NOTHING) {
+            cell = next;
+            changed = true;
+          }
+        }
+        if (neighbours & (1 << (RIGHT - 1))) {
+          uint8_t& cell = mField[layoutStepRight(index, y)];
+          if (cell == NOTHING) {
+            cell = next;
+            changed = true;
+          }
+        }
+        if (neighbours & (1 << (LEFT - 1))) {
+          uint8_t& cell = mField[layoutStepLeft(index, y)];
+          if (cell == NOTHING) {
+            cell = next;
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+boolean DistanceField::bordersUnknown(uint8_t x, uint8_t y) {
+  return getValue(x + 1, y) == UNKNOWN ||
+         getValue(x - 1, y) == UNKNOWN ||
+         getValue(x, y + 1) == UNKNOWN ||
+         getValue(x, y - 1) == UNKNOWN;
+}
+
+uint8_t DistanceField::getSizeX() {
+  return mSizeX;
+}
+
+uint8_t DistanceField::getSizeY() {
+  return mSizeY;
+}
+
+uint8_t DistanceField::getGoalX() {
+  return mGoalX;
+}
+
+uint8_t DistanceField::getGoalY() {
+  return mGoalY;
+}
+
+uint8_t DistanceField::getValue(uint8_t x, uint8_t y) {
+  uint8_t value = NOTHING;
+  if (x < mSizeX && y < mSizeY) {
+    value = mField[layoutIndex(x, y)];
+  }
+  return value;
+}
+
+uint8_t DistanceField::directionFrom(uint8_t x, uint8_t y) {
+  if (x >= mSizeX || y >= mSizeY) {
+    return NOTHING;
+  }
+  // Blocked and unreached cells have no way to the goal, whatever their
+  // neighbours hold
+  uint8_t value = mField[layoutIndex(x, y)];
+  if (value == GOAL || value == NOTHING || value == WALL || value == UNKNOWN) {
+    return NOTHING;
+  }
+
+  uint8_t minimum = RESET_MIN;
+  uint8_t direction = NOTHING;
+
+  if (reached(x + 1, y, minimum)) {
+    minimum = mField[layoutIndex(x + 1, y)];
+    direction = DOWN;
+  }
+  if (reached(x - 1, y, minimum)) {
+    minimum = mField[layoutIndex(x - 1, y)];
+    direction = UP;
+  }
+  if (reached(x, y + 1, minimum)) {
+    minimum = mField[layoutIndex(x, y + 1)];
+    direction = RIGHT;
+  }
+  if (reached(x, y - 1, minimum)) {
+    minimum = mField[layoutIndex(x, y - 1)];
+    direction = LEFT;
+  }
+
+  return direction;
+}
+
+boolean DistanceField::reached(uint8_t x, uint8_t y, uint8_t minimum) {
+  if (x >= mSizeX || y >= mSizeY) {
+    return false;
+  }
+  uint8_t value = mField[layoutIndex(x, y)];
+  return value != NOTHING && value < minimum;
+}
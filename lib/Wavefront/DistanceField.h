@@ -0,0 +1,190 @@
+#ifndef _DistanceField_h_
+#define _DistanceField_h_
+
+class Map;
+
+class CellQueue;
+
+class Coordinate;
+
+class CellSet;
+
+class FloorPlan;
+
+/**
+ * The fully propagated wavefront for one goal: every grid cell that can
+ * reach the goal holds its distance from it, using the same values that
+ * Map::propagateWavefront() writes (GOAL on the goal, GOAL + 1 next to it
+ * and so on). Cells that cannot reach the goal hold NOTHING and walls
+ * hold WALL (or UNKNOWN). As with the map, distances stop growing at
+ * RESET_MIN.
+ *
+ * Unlike Map::propagateWavefront(), the field is computed with a single
+ * breadth-first pass, does not stop when it reaches the ROBOT and leaves
+ * the map untouched, so one field answers the way to the goal from every
+ * cell on the map.
+ */
+class DistanceField {
+
+  public:
+
+    /**
+     * Constructs an empty field in which no cell can reach a goal.
+     */
+    DistanceField();
+
+    /**
+     * Propagates the field outwards from the goal location over every
+     * grid cell of the map that does not hold a WALL or UNKNOWN. The
+     * queue is scratch space for the propagation.
+     */
+    void compute(Map& map, uint8_t goalX, uint8_t goalY, CellQueue& queue);
+
+    /**
+     * As DistanceField::compute(), but over the static walls of a floor
+     * plan, which may be in flash, plus the cells of the overlay as
+     * further walls (obstacles that come and go), so no Map is needed
+     * in RAM at all. The wave spreads along the plan's neighbour masks,
+     * sweeping the field once per distance instead of using a queue, so
+     * the field and the overlay are all the RAM it takes. A plan larger
+     * than the field's storage leaves the field empty.
+     */
+    void compute(FloorPlan& plan, CellSet& overlay, uint8_t goalX, uint8_t goalY);
+
+    /**
+     * As DistanceField::compute(), but stops as soon as the wave reaches
+     * the stop location, leaving the rest of the field unpropagated.
+     * Every cell the wave did reach has its final value, so the way to
+     * the goal from the stop location can still be followed with
+     * DistanceField::directionFrom(). Returns true if the stop location
+     * was reached.
+     */
+    boolean computeUntil(Map& map,
+                         uint8_t goalX,
+                         uint8_t goalY,
+                         CellQueue& queue,
+                         uint8_t stopX,
+                         uint8_t stopY);
+
+    /**
+     * Starts DistanceField::computeUntil() without running the wave, so
+     * that it can be run a slice at a time with DistanceField::resume()
+     * in between other work. The queue holds the wave's progress and
+     * must be left alone until the wave is done.
+     */
+    void begin(Map& map,
+               uint8_t goalX,
+               uint8_t goalY,
+               CellQueue& queue,
+               uint8_t stopX,
+               uint8_t stopY);
+
+    /**
+     * Runs the wave started by DistanceField::begin() for at most budget
+     * more grid cells. Returns true once the wave is done, either because
+     * it reached the stop location or because there is nothing left for
+     * it to reach; the field then holds what DistanceField::computeUntil()
+     * would have left.
+     */
+    boolean resume(CellQueue& queue, uint16_t budget);
+
+    /**
+     * Finds the nearest frontier: the closest grid cell the robot can
+     * reach that borders an UNKNOWN one. This is a single wave outwards
+     * from the robot that stops as soon as it settles a frontier cell.
+     *
+     * Returns the direction of the robot's first step towards the
+     * frontier and populates the coordinate with the frontier location.
+     * If the robot is itself on a frontier, NOTHING is returned with the
+     * robot's location. If there is no reachable frontier, NOTHING is
+     * returned and both coordinates are 0xff.
+     *
+     * Afterwards the field holds the partial wave from the robot, with
+     * the robot's location as its goal.
+     */
+    uint8_t nearestFrontier(Map& map,
+                            uint8_t robotX,
+                            uint8_t robotY,
+                            CellQueue& queue,
+                            Coordinate& frontier);
+
+    /**
+     * Sets every cell of a sizeX x sizeY field to value, ready for
+     * DistanceField::placeValue() and DistanceField::spreadUntil(). This
+     * lets a caller propagate over a grid that is not a Map, such as a
+     * downsampled one, or over part of a map by filling it with WALL and
+     * opening up only the cells of interest.
+     */
+    void fill(uint8_t sizeX, uint8_t sizeY, uint8_t value);
+
+    /**
+     * Sets the value of one cell before DistanceField::spreadUntil():
+     * NOTHING for an open cell, WALL for a blocked one.
+     */
+    void placeValue(uint8_t x, uint8_t y, uint8_t value);
+
+    /**
+     * As DistanceField::computeUntil(), but over the cells set up with
+     * DistanceField::fill() and DistanceField::placeValue().
+     */
+    boolean spreadUntil(uint8_t goalX,
+                        uint8_t goalY,
+                        CellQueue& queue,
+                        uint8_t stopX,
+                        uint8_t stopY);
+
+    /**
+     * Gets the number of X (Y) grid cells in the field. This is the size
+     * of the map the field was last computed for.
+     */
+    uint8_t getSizeX();
+    uint8_t getSizeY();
+
+    /**
+     * Gets the location of the goal the field was last computed for.
+     */
+    uint8_t getGoalX();
+    uint8_t getGoalY();
+
+    /**
+     * Gets the propagated value of the specified grid cell.
+     */
+    uint8_t getValue(uint8_t x, uint8_t y);
+
+    /**
+     * Returns the direction to move from the specified grid cell to get
+     * one step closer to the goal, or NOTHING if the cell is the goal or
+     * cannot reach it. Ties are broken in the same order as
+     * Map::minSurroundingNode().
+     */
+    uint8_t directionFrom(uint8_t x, uint8_t y);
+
+  private:
+
+    uint16_t propagate(Map& map,
+                       uint8_t fromX,
+                       uint8_t fromY,
+                       CellQueue& queue,
+                       boolean toFrontier,
+                       uint16_t stop,
+                       uint32_t budget);
+    uint16_t spread(uint8_t fromX,
+                    uint8_t fromY,
+                    CellQueue& queue,
+                    boolean toFrontier,
+                    uint16_t stop,
+                    uint32_t budget);
+    uint16_t wave(CellQueue& queue, boolean toFrontier, uint16_t stop, uint32_t budget);
+    void spreadOver(FloorPlan& plan, uint8_t fromX, uint8_t fromY);
+    boolean bordersUnknown(uint8_t x, uint8_t y);
+    boolean reached(uint8_t x, uint8_t y, uint8_t minimum);
+
+    uint8_t mSizeX;
+    uint8_t mSizeY;
+    uint8_t mGoalX;
+    uint8_t mGoalY;
+    uint16_t mStop;
+    uint8_t mField[MAP_LAYOUT_CELLS];
+};
+
+#endif
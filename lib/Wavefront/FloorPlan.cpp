@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "FloorPlan.h"
+
+/*
+ * Layout of the table:
+ *
+ *   [0]                     sizeX
+ *   [1]                     sizeY
+ *   [2, 2 + wallBytes)      one bit per cell, set for a wall
+ *   [2 + wallBytes, ...)    four bits per cell, the neighbour mask, two
+ *                           cells to a byte with the even cell low
+ */
+#define HEADER_BYTES 2
+
+static const int8_t STEP_X[] = { 0, -1, 0, 1, 0 };
+static const int8_t STEP_Y[] = { 0, 0, 1, 0, -1 };
+
+boolean FloorPlan::build(Map& map, uint8_t *table, uint32_t length) {
+  uint8_t sizeX = map.getSizeX();
+  uint8_t sizeY = map.getSizeY();
+  uint16_t cells = (uint16_t)sizeX * sizeY;
+
+  if (length < (uint32_t)FLOOR_PLAN_BYTES(sizeX, sizeY)) {
+    return false;
+  }
+
+  for (uint16_t i=0; i<FLOOR_PLAN_BYTES(sizeX, sizeY); i++) {
+    table[i] = 0;
+  }
+  table[0] = sizeX;
+  table[1] = sizeY;
+
+  uint8_t *walls = table + HEADER_BYTES;
+  uint8_t *masks = walls + (cells + 7) / 8;
+
+  for (uint8_t x=0; x<sizeX; x++) {
+    for (uint8_t y=0; y<sizeY; y++) {
+      if (map.getValue(x, y) == WALL) {
+        uint16_t cell = (uint16_t)x * sizeY + y;
+        walls[cell >> 3] |= 1 << (cell & 7);
+      }
+    }
+  }
+
+  for (uint8_t x=0; x<sizeX; x++) {
+    for (uint8_t y=0; y<sizeY; y++) {
+      if (map.getValue(x, y) == WALL) {
+        continue;
+      }
+
+      // Off the map counts as a wall
+      uint8_t mask = 0;
+      for (uint8_t direction=UP; direction<=LEFT; direction++) {
+        uint8_t nextX = x + STEP_X[direction];
+        uint8_t nextY = y + STEP_Y[direction];
+        if (nextX < sizeX && nextY < sizeY && map.getValue(nextX, nextY) != WALL) {
+          mask |= 1 << (direction - 1);
+        }
+      }
+
+      uint16_t cell = (uint16_t)x * sizeY + y;
+      masks[cell >> 1] |= mask << ((cell & 1) * 4);
+    }
+  }
+
+  return true;
+}
+
+FloorPlan::FloorPlan(const uint8_t *table, boolean inProgmem) {
+  mTable = table;
+  mInProgmem = inProgmem;
+  mSizeX = readByte(0);
+  mSizeY = readByte(1);
+}
+
+uint8_t FloorPlan::getSizeX() {
+  return mSizeX;
+}
+
+uint8_t FloorPlan::getSizeY() {
+  return mSizeY;
+}
+
+boolean FloorPlan::isWall(uint8_t x, uint8_t y) {
+  if (x >= mSizeX || y >= mSizeY) {
+    return true;
+  }
+  uint16_t cell = (uint16_t)x * mSizeY + y;
+  return (readByte(HEADER_BYTES + (cell >> 3)) >> (cell & 7)) & 1;
+}
+
+uint8_t FloorPlan::getNeighbours(uint8_t x, uint8_t y) {
+  if (x >= mSizeX || y >= mSizeY) {
+    return 0;
+  }
+  uint16_t cells = (uint16_t)mSizeX * mSizeY;
+  uint16_t cell = (uint16_t)x * mSizeY + y;
+  return (readByte(HEADER_BYTES + (cells + 7) / 8 + (cell >> 1)) >> ((cell & 1) * 4)) & 0x0f;
+}
+
+void FloorPlan::apply(Map& map) {
+  for (uint8_t x=0; x<mSizeX; x++) {
+    for (uint8_t y=0; y<mSizeY; y++) {
+      if (isWall(x, y)) {
+        map.placeValue(x, y, WALL);
+      }
+    }
+  }
+}
+
+uint8_t FloorPlan::readByte(uint16_t offset) {
+  if (mInProgmem) {
+    return pgm_read_byte(mTable + offset);
+  }
+  return mTable[offset];
+}
@@ -0,0 +1,77 @@
+#ifndef _FloorPlan_h_
+#define _FloorPlan_h_
+
+/**
+ * The number of bytes needed to hold a FloorPlan for a map of
+ * sizeX x sizeY grid cells: a two byte header holding the size, one bit
+ * per cell for the walls and four bits per cell for its neighbour mask.
+ * A 10x10 map needs 65 bytes. Being a constant expression, it can be
+ * checked against the size of the array a plan is compiled into.
+ */
+#define FLOOR_PLAN_BYTES(sizeX, sizeY) \
+  (2 + ((uint16_t)(sizeX) * (sizeY) + 7) / 8 + ((uint16_t)(sizeX) * (sizeY) + 1) / 2)
+
+class Map;
+
+/**
+ * The walls of a floor layout that never changes, as a read-only table
+ * that can be compiled into flash with PROGMEM (tools/floorplangen
+ * generates one from a map file) so that it costs no RAM. Next to the
+ * wall bits the table holds a mask for every cell with bit
+ * (direction - 1) set for each direction the wave can spread to, so a
+ * propagation over the plan (see DistanceField::compute()) does no
+ * range or wall checks of its own.
+ *
+ * Cells are numbered x * sizeY + y whatever the MAP_LAYOUT, so a table
+ * can be built on the host and used on the board.
+ */
+class FloorPlan {
+
+  public:
+
+    /**
+     * Writes the plan for the WALL cells of the map into the buffer,
+     * which must hold at least FLOOR_PLAN_BYTES() bytes. Returns false
+     * if it is too small.
+     */
+    static boolean build(Map& map, uint8_t *table, uint32_t length);
+
+    /**
+     * Wraps a table built by FloorPlan::build(). Pass true for
+     * inProgmem if the table was placed in flash with PROGMEM.
+     */
+    FloorPlan(const uint8_t *table, boolean inProgmem);
+
+    uint8_t getSizeX();
+    uint8_t getSizeY();
+
+    /**
+     * Returns true if the grid cell x, y is a wall or off the plan.
+     */
+    boolean isWall(uint8_t x, uint8_t y);
+
+    /**
+     * Gets the mask of directions from the grid cell x, y to neighbours
+     * on the plan that are not walls; bit (UP - 1) for UP and so on. The
+     * mask of a wall, or of a cell off the plan, is 0.
+     */
+    uint8_t getNeighbours(uint8_t x, uint8_t y);
+
+    /**
+     * Places a WALL on the map for every wall of the plan, so the static
+     * layout only has to be stored once, in flash, for maps built at
+     * run time.
+     */
+    void apply(Map& map);
+
+  private:
+
+    uint8_t readByte(uint16_t offset);
+
+    const uint8_t *mTable;
+    boolean mInProgmem;
+    uint8_t mSizeX;
+    uint8_t mSizeY;
+};
+
+#endif
@@ -1,6 +1,19 @@
+#ifndef _IWavefront_h_
+#define _IWavefront_h_
+
 class Map;
 
 class IWavefront {
   public:
     virtual void wave(Map& map) = 0;
+
+    /**
+     * Called by Map::propagateWavefront() each time a cell takes a new
+     * wave value, before the wave() call that ends the iteration. Cells
+     * whose value does not change are not reported. Override it to
+     * follow the wave without rescanning the whole map.
+     */
+    virtual void relabel(uint8_t, uint8_t, uint8_t) {}
 };
+
+#endif
@@ -6,6 +6,24 @@
 
 #define PROPAGATE_ITERATIONS 50
 
+/*
+ * Zobrist-style key for a grid cell: the obstacle hash is the XOR of
+ * the keys of all blocked cells, so toggling one cell is a single XOR.
+ * The keys are derived by mixing the coordinates rather than stored in
+ * a table to save RAM.
+ */
+static uint32_t cellKey(uint8_t x, uint8_t y) {
+  uint32_t key = ((uint32_t)x << 8 | y) * 0x9e3779b1UL;
+  key ^= key >> 15;
+  key *= 0x85ebca77UL;
+  key ^= key >> 13;
+  return key;
+}
+
+static boolean blocked(uint8_t value) {
+  return value == WALL || value == UNKNOWN;
+}
+
 Map::Map() : Map::Map(DEFAULT_X_SIZE, DEFAULT_Y_SIZE) {
 }
 
@@ -34,13 +52,26 @@ void Map::placeValue(uint8_t x, uint8_t y, uint8_t value) {
     return;
   }
 
-  mMap[x][y] = value;
+  uint8_t& cell = mMap[layoutIndex(x, y)];
+  if (blocked(cell) != blocked(value)) {
+    mObstacleHash ^= cellKey(x, y);
+  }
+
+  if (value == ROBOT) {
+    mRobotX = x;
+    mRobotY = y;
+  } else if (value == GOAL) {
+    mGoalX = x;
+    mGoalY = y;
+  }
+
+  cell = value;
 }
 
 uint8_t Map::getValue(uint8_t x, uint8_t y) {
   uint8_t value = NOTHING;
   if (coordinateInRange(x, y)) {
-    value = mMap[x][y];
+    value = mMap[layoutIndex(x, y)];
   }
   return value;
 }
@@ -54,31 +85,49 @@ void Map::minSurroundingNode(uint8_t x, uint8_t y, MinValueDirection &mvd) {
   }
 
   if (nodeLessThanMinimum(x + 1, y, mvd.getNodeValue())) {
-    mvd.setNodeValue(mMap[x + 1][y]);
+    mvd.setNodeValue(mMap[layoutIndex(x + 1, y)]);
     mvd.setDirection(DOWN);
   }
 
   if (nodeLessThanMinimum(x - 1, y, mvd.getNodeValue())) {
-    mvd.setNodeValue(mMap[x - 1][y]);
+    mvd.setNodeValue(mMap[layoutIndex(x - 1, y)]);
     mvd.setDirection(UP);
   }
 
   if (nodeLessThanMinimum(x, y + 1, mvd.getNodeValue())) {
-    mvd.setNodeValue(mMap[x][y + 1]);
+    mvd.setNodeValue(mMap[layoutIndex(x, y + 1)]);
     mvd.setDirection(RIGHT);
   }
 
   if (nodeLessThanMinimum(x, y - 1, mvd.getNodeValue())) {
-    mvd.setNodeValue(mMap[x][y - 1]);
+    mvd.setNodeValue(mMap[layoutIndex(x, y - 1)]);
     mvd.setDirection(LEFT);
   }
 }
 
 void Map::clear() {
+  // Every blocked cell is about to go
+  mObstacleHash = 0;
+
   for (uint8_t x=0; x<mSizeX; x++) {
     for (uint8_t y=0; y<mSizeY; y++) {
-      if (mMap[x][y] != ROBOT && mMap[x][y] != GOAL) {
-        mMap[x][y] = NOTHING;
+      uint8_t& cell = mMap[layoutIndex(x, y)];
+      if (cell != ROBOT && cell != GOAL) {
+        cell = NOTHING;
+      }
+    }
+  }
+}
+
+void Map::forget() {
+  mObstacleHash = 0;
+
+  for (uint8_t x=0; x<mSizeX; x++) {
+    for (uint8_t y=0; y<mSizeY; y++) {
+      uint8_t& cell = mMap[layoutIndex(x, y)];
+      if (cell != ROBOT && cell != GOAL) {
+        cell = UNKNOWN;
+        mObstacleHash ^= cellKey(x, y);
       }
     }
   }
@@ -87,8 +136,9 @@ void Map::clear() {
 void Map::unpropagate() {
   for (uint8_t x=0; x<mSizeX; x++) {
     for (uint8_t y=0; y<mSizeY; y++) {
-      if (mMap[x][y] != ROBOT && mMap[x][y] != GOAL && mMap[x][y] != WALL) {
-        mMap[x][y] = NOTHING;
+      uint8_t& cell = mMap[layoutIndex(x, y)];
+      if (cell != ROBOT && cell != GOAL && cell != WALL && cell != UNKNOWN) {
+        cell = NOTHING;
       }
     }
   }
@@ -105,19 +155,23 @@ uint8_t Map::propagateWavefront(IWavefront *wavefront) {
   for (uint8_t i=0; i<PROPAGATE_ITERATIONS; i++) {
     for (uint8_t x=0; x<mSizeX; x++) {
       for (uint8_t y=0; y<mSizeY; y++) {
-        if (mMap[x][y] == WALL || mMap[x][y] == GOAL) {
+        uint8_t& cell = mMap[layoutIndex(x, y)];
+        if (cell == WALL || cell == GOAL || cell == UNKNOWN) {
           continue;
         }
 
         MinValueDirection mvd(RESET_MIN, NOTHING);
         minSurroundingNode(x, y, mvd);
-        if (mvd.getNodeValue() < RESET_MIN && mMap[x][y] == ROBOT) {
+        if (mvd.getNodeValue() < RESET_MIN && cell == ROBOT) {
           if (wavefront) {
             wavefront->wave(*this);
           }
           return mvd.getDirection();
-        } else if (mvd.getNodeValue() != RESET_MIN) {
-          mMap[x][y] = mvd.getNodeValue() + 1;
+        } else if (mvd.getNodeValue() != RESET_MIN && cell != mvd.getNodeValue() + 1) {
+          cell = mvd.getNodeValue() + 1;
+          if (wavefront) {
+            wavefront->relabel(x, y, cell);
+          }
         }
       }
     }
@@ -127,6 +181,9 @@ uint8_t Map::propagateWavefront(IWavefront *wavefront) {
       wavefront->wave(*this);
     }
   }
+
+  // No path between the ROBOT and the GOAL was found
+  return NOTHING;
 }
 
 void Map::gridLocationFromCenterRadius(uint8_t x, uint8_t y, double angle, double radius, Coordinate& coordinate) {
@@ -150,13 +207,59 @@ boolean Map::coordinateInRange(uint8_t x, uint8_t y) {
 }
 
 boolean Map::nodeLessThanMinimum(uint8_t x, uint8_t y, uint8_t minimum) {
-  return coordinateInRange(x, y) && mMap[x][y] != NOTHING && mMap[x][y] < minimum;
+  if (! coordinateInRange(x, y)) {
+    return false;
+  }
+  uint8_t value = mMap[layoutIndex(x, y)];
+  return value != NOTHING && value < minimum;
+}
+
+uint32_t Map::getObstacleHash() {
+  return mObstacleHash;
+}
+
+boolean Map::locateRobot(Coordinate& coordinate) {
+  if (! locateValue(ROBOT, mRobotX, mRobotY)) {
+    return false;
+  }
+  coordinate.setCoordinates(mRobotX, mRobotY);
+  return true;
+}
+
+boolean Map::locateGoal(Coordinate& coordinate) {
+  if (! locateValue(GOAL, mGoalX, mGoalY)) {
+    return false;
+  }
+  coordinate.setCoordinates(mGoalX, mGoalY);
+  return true;
+}
+
+boolean Map::locateValue(uint8_t value, uint8_t& x, uint8_t& y) {
+  if (coordinateInRange(x, y) && mMap[layoutIndex(x, y)] == value) {
+    return true;
+  }
+
+  // The remembered location was overwritten; fall back to a scan
+  for (uint8_t sx=0; sx<mSizeX; sx++) {
+    for (uint8_t sy=0; sy<mSizeY; sy++) {
+      if (mMap[layoutIndex(sx, sy)] == value) {
+        x = sx;
+        y = sy;
+        return true;
+      }
+    }
+  }
+  return false;
 }
 
 void Map::buildMap(uint8_t sizeX, uint8_t sizeY) {
+  mObstacleHash = 0;
+  mRobotX = mRobotY = 0xff;
+  mGoalX = mGoalY = 0xff;
+
   for (uint8_t x=0; x<mSizeX; x++) {
     for (uint8_t y=0; y<mSizeY; y++) {
-      mMap[x][y] = NOTHING;
+      mMap[layoutIndex(x, y)] = NOTHING;
     }
   }
 }
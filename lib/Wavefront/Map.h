@@ -12,11 +12,14 @@
  * GOAL    - Placed on a grid cell to indicate the goal of a 
  *           robot's movement.
  * ROBOT   - Placed on a grid cell at the robot's current location.
+ * UNKNOWN - Placed on a grid cell that has not been sensed yet. Like a
+ *           WALL, the wave does not propagate through it.
  */
 #define NOTHING (uint8_t)0
 #define WALL (uint8_t)255
 #define GOAL (uint8_t)1
 #define ROBOT (uint8_t)254
+#define UNKNOWN (uint8_t)253
 
 /**
  * These manifest constants define navigation directionality. The
@@ -68,6 +71,12 @@
 #define DOWN (uint8_t)3
 #define LEFT (uint8_t)4
 
+/**
+ * Planners that account for time (TimedPlanner, CooperativePlanner) also
+ * use this move, which keeps the robot where it is for one step.
+ */
+#define WAIT (uint8_t)5
+
 /**
  * This manifest constant is a special value to help determine how
  * to unpropagate the wavefront for a map.
@@ -90,9 +99,24 @@
  * reference by an 8-bit unsigned integer, so you can't have more
  * than 255 rows or columns. (The dimension 0xff is a special
  * value indicating an out-of-range dimension).
+ *
+ * Both values may be overridden on the compiler command line (e.g.
+ * -DDEFAULT_X_SIZE=64) to reserve storage for larger maps; every
+ * translation unit that uses Map must then see the same values.
  */
+#ifndef DEFAULT_X_SIZE
 #define DEFAULT_X_SIZE (uint8_t)10
+#endif
+#ifndef DEFAULT_Y_SIZE
 #define DEFAULT_Y_SIZE (uint8_t)10
+#endif
+
+/**
+ * The number of grid cells in a map of the default (largest) size.
+ */
+#define CELL_COUNT ((uint16_t)DEFAULT_X_SIZE * DEFAULT_Y_SIZE)
+
+#include "MapLayout.h"
 
 class Coordinate;
 
@@ -116,6 +140,18 @@ class Map {
      */
     Map();
 
+    /**
+     * Constructs a new Map that uses only the first sizeX x sizeY grid
+     * cells of its storage, with all grid cells set to NOTHING. The
+     * sizes must not exceed DEFAULT_X_SIZE and DEFAULT_Y_SIZE.
+     */
+    Map(uint8_t sizeX, uint8_t sizeY);
+
+    /**
+     * As above, but also sets the real-world size of each grid cell.
+     */
+    Map(uint8_t sizeX, uint8_t sizeY, double dimX, double dimY);
+
     /**
      * Gets the number of X grid cells in the map.
      */
@@ -162,9 +198,19 @@ class Map {
      */
     void clear();
 
+    /**
+     * Resets all grid cells to UNKNOWN except those marked with ROBOT or
+     * GOAL.
+     *
+     * You would typically call this before exploring an area whose layout
+     * is not known, and then place NOTHING or WALL on each grid cell as it
+     * is sensed.
+     */
+    void forget();
+
     /**
      * Resets all grid cells to NOTHING except those marked with ROBOT,
-     * GOAL or WALL.
+     * GOAL, WALL or UNKNOWN.
      */
     void unpropagate();
 
@@ -225,19 +271,43 @@ class Map {
      */
     boolean nodeLessThanMinimum(uint8_t x, uint8_t y, uint8_t minimum);
 
-  private:
+    /**
+     * Returns a hash of the set of grid cells the wave cannot propagate
+     * through (WALL or UNKNOWN). The hash is maintained incrementally by
+     * Map::placeValue(), Map::clear() and Map::forget(), so this is cheap
+     * to call before every plan. Two maps with the same blocked cells
+     * always have the same hash; maps with different ones almost always
+     * differ, but not always: the hash XORs a 32-bit key per blocked
+     * cell, so some sets of cells cancel out, and on a map of more than
+     * 32 cells some always do. Anything keyed on it, such as
+     * WavefrontCache, can then be handed results for other walls.
+     */
+    uint32_t getObstacleHash();
 
-    Map(uint8_t sizeX, uint8_t sizeY);
-    Map(uint8_t sizeX, uint8_t sizeY, double dimX, double dimY);
+    /**
+     * Populates the coordinate with the location of the ROBOT (or GOAL)
+     * and returns true, or returns false if there is none on the map.
+     * The location last placed with Map::placeValue() is checked first,
+     * so this is usually constant time.
+     */
+    boolean locateRobot(Coordinate& coordinate);
+    boolean locateGoal(Coordinate& coordinate);
 
+  private:
 
     void buildMap(uint8_t sizeX, uint8_t sizeY);
+    boolean locateValue(uint8_t value, uint8_t& x, uint8_t& y);
 
     uint8_t mSizeX;
     uint8_t mSizeY;
     double mDimX;
     double mDimY;
-    uint8_t mMap[DEFAULT_X_SIZE][DEFAULT_Y_SIZE];
+    uint32_t mObstacleHash;
+    uint8_t mRobotX;
+    uint8_t mRobotY;
+    uint8_t mGoalX;
+    uint8_t mGoalY;
+    uint8_t mMap[MAP_LAYOUT_CELLS];
 
 };
 
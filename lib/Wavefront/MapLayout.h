@@ -0,0 +1,146 @@
+#ifndef _MapLayout_h_
+#define _MapLayout_h_
+
+/**
+ * These manifest constants select how the grid cells of a Map (and of
+ * the planners' per-cell planes) are arranged in memory:
+ *
+ * MAP_LAYOUT_ROW_MAJOR - Cell x, y at x * DEFAULT_Y_SIZE + y. Smallest
+ *                        and fastest for the default 10x10 map, but a
+ *                        step along X jumps a whole row, which thrashes
+ *                        the cache on large maps.
+ * MAP_LAYOUT_TILED     - 8x8 tiles of row-major cells, themselves laid
+ *                        out row-major, so most neighbours share a tile.
+ * MAP_LAYOUT_MORTON    - Z-order: the bits of x and y interleaved, which
+ *                        keeps neighbours close at every scale. The grid
+ *                        is padded to a square power of two.
+ *
+ * Define MAP_LAYOUT on the compiler command line to pick one; every
+ * translation unit must see the same value. The layout is invisible
+ * through Map::placeValue() and Map::getValue().
+ */
+#define MAP_LAYOUT_ROW_MAJOR 0
+#define MAP_LAYOUT_TILED 1
+#define MAP_LAYOUT_MORTON 2
+
+#ifndef MAP_LAYOUT
+#define MAP_LAYOUT MAP_LAYOUT_ROW_MAJOR
+#endif
+
+#define MAP_TILE_SHIFT 3
+#define MAP_TILE_SIZE (1 << MAP_TILE_SHIFT)
+#define MAP_TILE_MASK (MAP_TILE_SIZE - 1)
+#define MAP_TILE_CELLS (MAP_TILE_SIZE * MAP_TILE_SIZE)
+#define MAP_TILES_Y ((DEFAULT_Y_SIZE + MAP_TILE_MASK) >> MAP_TILE_SHIFT)
+#define MAP_TILES_X ((DEFAULT_X_SIZE + MAP_TILE_MASK) >> MAP_TILE_SHIFT)
+
+#define MAP_LARGER_SIZE (DEFAULT_X_SIZE > DEFAULT_Y_SIZE ? DEFAULT_X_SIZE : DEFAULT_Y_SIZE)
+#define MAP_MORTON_SIZE \
+  (MAP_LARGER_SIZE <= 8 ? 8 : MAP_LARGER_SIZE <= 16 ? 16 : \
+   MAP_LARGER_SIZE <= 32 ? 32 : MAP_LARGER_SIZE <= 64 ? 64 : \
+   MAP_LARGER_SIZE <= 128 ? 128 : 256)
+
+/*
+ * In Z-order, x takes the odd bits of the index and y the even ones.
+ */
+#define MAP_MORTON_X_BITS 0xaaaa
+#define MAP_MORTON_Y_BITS 0x5555
+
+/**
+ * The number of storage cells needed for a DEFAULT_X_SIZE x
+ * DEFAULT_Y_SIZE grid in the selected layout.
+ */
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+#define MAP_LAYOUT_CELLS ((uint32_t)MAP_TILES_X * MAP_TILES_Y * MAP_TILE_CELLS)
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+#define MAP_LAYOUT_CELLS ((uint32_t)MAP_MORTON_SIZE * MAP_MORTON_SIZE)
+#else
+#define MAP_LAYOUT_CELLS ((uint32_t)DEFAULT_X_SIZE * DEFAULT_Y_SIZE)
+#endif
+
+/**
+ * Spreads the bits of an 8-bit value out to the even bits of a 16-bit
+ * one.
+ */
+static inline uint16_t layoutSpreadBits(uint8_t value) {
+  uint16_t bits = value;
+  bits = (bits | bits << 4) & 0x0f0f;
+  bits = (bits | bits << 2) & 0x3333;
+  bits = (bits | bits << 1) & 0x5555;
+  return bits;
+}
+
+/**
+ * Returns the storage index of grid cell x, y.
+ */
+static inline uint16_t layoutIndex(uint8_t x, uint8_t y) {
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+  uint16_t tile = (uint16_t)(x >> MAP_TILE_SHIFT) * MAP_TILES_Y + (y >> MAP_TILE_SHIFT);
+  return tile * MAP_TILE_CELLS + ((x & MAP_TILE_MASK) << MAP_TILE_SHIFT) + (y & MAP_TILE_MASK);
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+  return layoutSpreadBits(x) << 1 | layoutSpreadBits(y);
+#else
+  return (uint16_t)x * DEFAULT_Y_SIZE + y;
+#endif
+}
+
+/**
+ * Given the storage index of grid cell x, y, these return the index of
+ * the neighbouring cell in each direction without recomputing it from
+ * scratch: DOWN is x + 1, UP x - 1, RIGHT y + 1 and LEFT y - 1. The
+ * caller must make sure the neighbour is on the grid. Only the tiled
+ * layout needs the coordinate.
+ */
+static inline uint16_t layoutStepDown(uint16_t index, uint8_t x) {
+  (void)x;
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+  return ((x & MAP_TILE_MASK) != MAP_TILE_MASK)
+    ? index + MAP_TILE_SIZE
+    : index + MAP_TILES_Y * MAP_TILE_CELLS - (MAP_TILE_CELLS - MAP_TILE_SIZE);
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+  return (((index | MAP_MORTON_Y_BITS) + 1) & MAP_MORTON_X_BITS) | (index & MAP_MORTON_Y_BITS);
+#else
+  return index + DEFAULT_Y_SIZE;
+#endif
+}
+
+static inline uint16_t layoutStepUp(uint16_t index, uint8_t x) {
+  (void)x;
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+  return ((x & MAP_TILE_MASK) != 0)
+    ? index - MAP_TILE_SIZE
+    : index - MAP_TILES_Y * MAP_TILE_CELLS + (MAP_TILE_CELLS - MAP_TILE_SIZE);
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+  return (((index & MAP_MORTON_X_BITS) - 1) & MAP_MORTON_X_BITS) | (index & MAP_MORTON_Y_BITS);
+#else
+  return index - DEFAULT_Y_SIZE;
+#endif
+}
+
+static inline uint16_t layoutStepRight(uint16_t index, uint8_t y) {
+  (void)y;
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+  return ((y & MAP_TILE_MASK) != MAP_TILE_MASK)
+    ? index + 1
+    : index + MAP_TILE_CELLS - MAP_TILE_MASK;
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+  return (((index | MAP_MORTON_X_BITS) + 1) & MAP_MORTON_Y_BITS) | (index & MAP_MORTON_X_BITS);
+#else
+  return index + 1;
+#endif
+}
+
+static inline uint16_t layoutStepLeft(uint16_t index, uint8_t y) {
+  (void)y;
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+  return ((y & MAP_TILE_MASK) != 0)
+    ? index - 1
+    : index - MAP_TILE_CELLS + MAP_TILE_MASK;
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+  return (((index & MAP_MORTON_Y_BITS) - 1) & MAP_MORTON_Y_BITS) | (index & MAP_MORTON_X_BITS);
+#else
+  return index - 1;
+#endif
+}
+
+#endif
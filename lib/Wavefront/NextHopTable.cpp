@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "NextHopTable.h"
+
+/*
+ * Layout of the table:
+ *
+ *   [0]               sizeX
+ *   [1]               sizeY
+ *   [2, 2 + cells)    area of each cell; 0 for a WALL or UNKNOWN cell,
+ *                     otherwise cells
+ *                     sharing a number can reach one another
+ *   [2 + cells, ...)  two bits per (goal, cell) pair holding the
+ *                     direction minus one, four pairs to a byte
+ */
+#define HEADER_BYTES 2
+
+boolean NextHopTable::build(Map& map,
+                            uint8_t *table,
+                            uint32_t length,
+                            DistanceField& field,
+                            CellQueue& queue) {
+  uint8_t sizeX = map.getSizeX();
+  uint8_t sizeY = map.getSizeY();
+  uint16_t cells = (uint16_t)sizeX * sizeY;
+
+  if (length < NEXT_HOP_TABLE_BYTES(sizeX, sizeY)) {
+    return false;
+  }
+
+  for (uint32_t i=0; i<NEXT_HOP_TABLE_BYTES(sizeX, sizeY); i++) {
+    table[i] = 0;
+  }
+  table[0] = sizeX;
+  table[1] = sizeY;
+
+  uint8_t *areas = table + HEADER_BYTES;
+  uint8_t *hops = areas + cells;
+  if (! numberAreas(map, areas, queue)) {
+    return false;
+  }
+
+  for (uint8_t goalX=0; goalX<sizeX; goalX++) {
+    for (uint8_t goalY=0; goalY<sizeY; goalY++) {
+      uint16_t goal = (uint16_t)goalX * sizeY + goalY;
+      if (areas[goal] == 0) {
+        continue;
+      }
+
+      field.compute(map, goalX, goalY, queue);
+
+      for (uint8_t x=0; x<sizeX; x++) {
+        for (uint8_t y=0; y<sizeY; y++) {
+          uint16_t cell = (uint16_t)x * sizeY + y;
+          if (cell == goal || areas[cell] != areas[goal]) {
+            continue;
+          }
+
+          // Every direction is a valid hop, so a pair the field never
+          // reached cannot be told apart from one it did
+          uint8_t direction = field.directionFrom(x, y);
+          if (direction == NOTHING) {
+            return false;
+          }
+          uint32_t pair = (uint32_t)goal * cells + cell;
+          hops[pair >> 2] |= (direction - 1) << ((pair & 3) * 2);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/*
+ * Numbers the open areas with a flood fill of its own rather than from
+ * the fields, which stop growing at RESET_MIN and so would split a long
+ * area in two.
+ */
+boolean NextHopTable::numberAreas(Map& map, uint8_t *areas, CellQueue& queue) {
+  uint8_t sizeX = map.getSizeX();
+  uint8_t sizeY = map.getSizeY();
+  uint8_t lastArea = 0;
+
+  for (uint8_t startX=0; startX<sizeX; startX++) {
+    for (uint8_t startY=0; startY<sizeY; startY++) {
+      if (areas[(uint16_t)startX * sizeY + startY] != 0 || blocked(map, startX, startY)) {
+        continue;
+      }
+      if (lastArea == 0xfe) {
+        return false;
+      }
+      lastArea++;
+
+      queue.clear();
+      areas[(uint16_t)startX * sizeY + startY] = lastArea;
+      queue.push(startX, startY);
+      while (! queue.isEmpty()) {
+        uint8_t x;
+        uint8_t y;
+        queue.pop(x, y);
+
+        // Unsigned wrap-around takes care of x - 1 and y - 1 at the edges
+        uint8_t nextX[4] = { (uint8_t)(x + 1), (uint8_t)(x - 1), x, x };
+        uint8_t nextY[4] = { y, y, (uint8_t)(y + 1), (uint8_t)(y - 1) };
+        for (uint8_t i=0; i<4; i++) {
+          if (nextX[i] >= sizeX || nextY[i] >= sizeY) {
+            continue;
+          }
+          uint8_t& area = areas[(uint16_t)nextX[i] * sizeY + nextY[i]];
+          if (area == 0 && ! blocked(map, nextX[i], nextY[i])) {
+            area = lastArea;
+            queue.push(nextX[i], nextY[i]);
+          }
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+boolean NextHopTable::blocked(Map& map, uint8_t x, uint8_t y) {
+  uint8_t value = map.getValue(x, y);
+  return value == WALL || value == UNKNOWN;
+}
+
+NextHopTable::NextHopTable(const uint8_t *table, boolean inProgmem) {
+  mTable = table;
+  mInProgmem = inProgmem;
+  mSizeX = readByte(0);
+  mSizeY = readByte(1);
+}
+
+uint8_t NextHopTable::getSizeX() {
+  return mSizeX;
+}
+
+uint8_t NextHopTable::getSizeY() {
+  return mSizeY;
+}
+
+uint8_t NextHopTable::nextHop(uint8_t goalX, uint8_t goalY, uint8_t x, uint8_t y) {
+  if (goalX >= mSizeX || goalY >= mSizeY || x >= mSizeX || y >= mSizeY) {
+    return NOTHING;
+  }
+
+  uint16_t cells = (uint16_t)mSizeX * mSizeY;
+  uint16_t goal = (uint16_t)goalX * mSizeY + goalY;
+  uint16_t cell = (uint16_t)x * mSizeY + y;
+  uint8_t area = readByte(HEADER_BYTES + cell);
+
+  if (cell == goal || area == 0 || area != readByte(HEADER_BYTES + goal)) {
+    return NOTHING;
+  }
+
+  uint32_t pair = (uint32_t)goal * cells + cell;
+  uint8_t hops = readByte(HEADER_BYTES + cells + (pair >> 2));
+  return ((hops >> ((pair & 3) * 2)) & 3) + 1;
+}
+
+uint8_t NextHopTable::readByte(uint32_t offset) {
+  if (mInProgmem) {
+    return pgm_read_byte(mTable + offset);
+  }
+  return mTable[offset];
+}
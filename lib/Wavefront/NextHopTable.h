@@ -0,0 +1,82 @@
+#ifndef _NextHopTable_h_
+#define _NextHopTable_h_
+
+/**
+ * The number of bytes needed to hold a NextHopTable for a map of
+ * sizeX x sizeY grid cells: a two byte header holding the size, one
+ * connectivity byte per cell and two bits for every (goal, cell) pair.
+ * A 10x10 map needs 2602 bytes.
+ */
+#define NEXT_HOP_TABLE_BYTES(sizeX, sizeY) \
+  (2 + (uint32_t)(sizeX) * (sizeY) + \
+   ((uint32_t)(sizeX) * (sizeY) * (sizeX) * (sizeY) + 3) / 4)
+
+class Map;
+
+class CellQueue;
+
+class DistanceField;
+
+/**
+ * A precomputed table holding, for every goal cell and every other cell
+ * of a map whose walls never change, the direction to move to get one
+ * step closer to that goal. With the table built (on the host, or once
+ * at startup) navigating to any goal is a walk through the table with
+ * no propagation at all.
+ *
+ * The table is a plain byte array, so it can be written to a file or
+ * compiled into flash with PROGMEM and read from there directly.
+ */
+class NextHopTable {
+
+  public:
+
+    /**
+     * Computes the table for the walls on the map into the buffer, which
+     * must hold at least NEXT_HOP_TABLE_BYTES() bytes. The field and
+     * queue are scratch space. Returns false if the buffer is too small,
+     * the map has more than 254 separate open areas, or any cell is more
+     * than RESET_MIN - GOAL - 1 steps from a goal in its own area: the
+     * fields stop growing there, so the table could not hold its way to
+     * the goal. This is only meant for small maps.
+     */
+    static boolean build(Map& map,
+                         uint8_t *table,
+                         uint32_t length,
+                         DistanceField& field,
+                         CellQueue& queue);
+
+    /**
+     * Wraps a table built by NextHopTable::build(). Pass true for
+     * inProgmem if the table was placed in flash with PROGMEM.
+     */
+    NextHopTable(const uint8_t *table, boolean inProgmem);
+
+    /**
+     * Gets the number of X (Y) grid cells of the map the table was
+     * built for.
+     */
+    uint8_t getSizeX();
+    uint8_t getSizeY();
+
+    /**
+     * Returns the direction to move from the grid cell x, y towards the
+     * goal, or NOTHING if the cell is the goal, either location is a
+     * WALL, UNKNOWN or off the map, or there is no path between them.
+     */
+    uint8_t nextHop(uint8_t goalX, uint8_t goalY, uint8_t x, uint8_t y);
+
+  private:
+
+    static boolean numberAreas(Map& map, uint8_t *areas, CellQueue& queue);
+    static boolean blocked(Map& map, uint8_t x, uint8_t y);
+
+    uint8_t readByte(uint32_t offset);
+
+    const uint8_t *mTable;
+    boolean mInProgmem;
+    uint8_t mSizeX;
+    uint8_t mSizeY;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include <Arduino.h>
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "Path.h"
+#include "ObservationQueue.h"
+
+/*
+ * The producer owns mTail and the consumer owns mHead. Each publishes
+ * its index with a release store after touching the slot and reads the
+ * other's with an acquire load. Both are single bytes, which the AVR
+ * reads and writes in one instruction, so this is safe against interrupt
+ * handlers there and against other threads on the host.
+ */
+#define INDEX_MASK (OBSERVATION_QUEUE_SIZE - 1)
+
+ObservationQueue::ObservationQueue() {
+  mHead = 0;
+  mTail = 0;
+  mDropped = 0;
+}
+
+boolean ObservationQueue::push(const Observation& observation) {
+  uint8_t tail = mTail;
+  uint8_t head = __atomic_load_n(&mHead, __ATOMIC_ACQUIRE);
+
+  if ((uint8_t)(tail - head) >= OBSERVATION_QUEUE_SIZE) {
+    mDropped++;
+    return false;
+  }
+
+  mRing[tail & INDEX_MASK] = observation;
+  __atomic_store_n(&mTail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+  return true;
+}
+
+boolean ObservationQueue::pushCell(uint8_t x, uint8_t y, uint8_t value) {
+  Observation observation = { OBSERVATION_CELL, x, y, value, 0, 0 };
+  return push(observation);
+}
+
+boolean ObservationQueue::pushRange(uint8_t x, uint8_t y, int16_t angle, uint16_t range, uint8_t value) {
+  Observation observation = { OBSERVATION_RANGE, x, y, value, angle, range };
+  return push(observation);
+}
+
+boolean ObservationQueue::pop(Observation& observation) {
+  uint8_t head = mHead;
+  uint8_t tail = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+
+  if (head == tail) {
+    return false;
+  }
+
+  observation = mRing[head & INDEX_MASK];
+  __atomic_store_n(&mHead, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+  return true;
+}
+
+uint8_t ObservationQueue::drain(Map& map, DistanceField& plan, uint8_t robotX, uint8_t robotY) {
+  uint8_t result = OBSERVATIONS_NONE;
+  boolean wallsAdded = false;
+
+  // Only what is queued now; readings arriving meanwhile wait for the
+  // next batch so a busy sensor cannot keep the planner here forever.
+  uint8_t pending = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE) - mHead;
+
+  Observation observation;
+  while (pending-- && pop(observation)) {
+    uint8_t x;
+    uint8_t y;
+    if (! apply(map, observation, x, y)) {
+      continue;
+    }
+
+    if (result == OBSERVATIONS_NONE) {
+      result = OBSERVATIONS_APPLIED;
+    }
+
+    uint8_t previous = plan.getValue(x, y);
+    if (observation.value == GOAL) {
+      result = OBSERVATIONS_AFFECT_PATH;
+    } else if (observation.value == WALL || observation.value == UNKNOWN) {
+      wallsAdded = wallsAdded || (previous != NOTHING && previous != WALL && previous != UNKNOWN);
+    } else if (previous == WALL || previous == UNKNOWN) {
+      // An opening next to any planned cell might be a short cut
+      if (plan.getValue(x + 1, y) != NOTHING ||
+          plan.getValue(x - 1, y) != NOTHING ||
+          plan.getValue(x, y + 1) != NOTHING ||
+          plan.getValue(x, y - 1) != NOTHING) {
+        result = OBSERVATIONS_AFFECT_PATH;
+      }
+    }
+  }
+
+  if (result != OBSERVATIONS_AFFECT_PATH && wallsAdded &&
+      wallOnPath(map, plan, robotX, robotY)) {
+    result = OBSERVATIONS_AFFECT_PATH;
+  }
+
+  return result;
+}
+
+uint8_t ObservationQueue::drain(Map& map, Path& path, uint16_t& repairFrom) {
+  uint8_t result = PATH_VALID;
+  uint8_t pending = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE) - mHead;
+
+  Observation observation;
+  while (pending-- && pop(observation)) {
+    uint8_t x;
+    uint8_t y;
+    uint16_t from;
+    if (! apply(map, observation, x, y) || result == PATH_REPLAN) {
+      continue;
+    }
+
+    if (observation.value == GOAL) {
+      result = PATH_REPLAN;
+      continue;
+    }
+
+    switch (path.check(map, x, y, from)) {
+      case PATH_REPLAN:
+        result = PATH_REPLAN;
+        break;
+      case PATH_REPAIR:
+        if (result == PATH_VALID || from < repairFrom) {
+          repairFrom = from;
+        }
+        result = PATH_REPAIR;
+        break;
+    }
+  }
+
+  return result;
+}
+
+uint16_t ObservationQueue::getDropped() {
+  return mDropped;
+}
+
+/*
+ * Places the observation on the map and returns true if that changed
+ * the grid cell at x, y.
+ */
+boolean ObservationQueue::apply(Map& map, Observation& observation, uint8_t& x, uint8_t& y) {
+  x = observation.x;
+  y = observation.y;
+
+  if (observation.kind == OBSERVATION_RANGE) {
+    Coordinate seen;
+    map.gridLocationFromCenterRadius(x, y, observation.angle, observation.range, seen);
+    x = seen.getX();
+    y = seen.getY();
+  }
+
+  if (! map.coordinateInRange(x, y) || map.getValue(x, y) == observation.value) {
+    return false;
+  }
+
+  map.placeValue(x, y, observation.value);
+  return true;
+}
+
+/*
+ * Follows the plan from the robot to the goal looking for a WALL or
+ * UNKNOWN cell.
+ */
+boolean ObservationQueue::wallOnPath(Map& map, DistanceField& plan, uint8_t robotX, uint8_t robotY) {
+  uint8_t x = robotX;
+  uint8_t y = robotY;
+  uint16_t steps = (uint16_t)map.getSizeX() * map.getSizeY();
+
+  while (steps--) {
+    switch (plan.directionFrom(x, y)) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+      default: return false;
+    }
+    uint8_t value = map.getValue(x, y);
+    if (value == WALL || value == UNKNOWN) {
+      return true;
+    }
+  }
+  return false;
+}
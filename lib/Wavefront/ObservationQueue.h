@@ -0,0 +1,122 @@
+#ifndef _ObservationQueue_h_
+#define _ObservationQueue_h_
+
+/**
+ * The number of observations an ObservationQueue can hold before new
+ * ones are dropped. Must be a power of two no larger than 128.
+ */
+#ifndef OBSERVATION_QUEUE_SIZE
+#define OBSERVATION_QUEUE_SIZE 16
+#endif
+
+/**
+ * These manifest constants define the kinds of observation:
+ *
+ * OBSERVATION_CELL  - Place value on grid cell x, y.
+ * OBSERVATION_RANGE - A range sensor on grid cell x, y looking out at
+ *                     angle (degrees) saw something range away (same
+ *                     units as DEFAULT_DIM_X); value is placed on the
+ *                     grid cell where it was seen.
+ */
+#define OBSERVATION_CELL (uint8_t)0
+#define OBSERVATION_RANGE (uint8_t)1
+
+/**
+ * These manifest constants are the results of ObservationQueue::drain():
+ *
+ * OBSERVATIONS_NONE        - Nothing on the map changed.
+ * OBSERVATIONS_APPLIED     - The map changed, but not in a way that
+ *                            affects the current plan.
+ * OBSERVATIONS_AFFECT_PATH - A WALL (or UNKNOWN) appeared on the planned
+ *                            path, one next to the planned area
+ *                            disappeared (which may open a shorter path)
+ *                            or a GOAL was placed, so the robot should
+ *                            re-plan.
+ */
+#define OBSERVATIONS_NONE (uint8_t)0
+#define OBSERVATIONS_APPLIED (uint8_t)1
+#define OBSERVATIONS_AFFECT_PATH (uint8_t)2
+
+class Map;
+
+class DistanceField;
+
+class Path;
+
+/**
+ * One sensor reading waiting to be applied to the map.
+ */
+struct Observation {
+  uint8_t kind;
+  uint8_t x;
+  uint8_t y;
+  uint8_t value;
+  int16_t angle;
+  uint16_t range;
+};
+
+/**
+ * A fixed-size single-producer, single-consumer ring of observations.
+ * Sensor callbacks (interrupt handlers on the board, reader threads on
+ * the host) push readings at any time without blocking; the planner
+ * drains the whole batch into the map between plans. No locks are taken
+ * and interrupts stay enabled.
+ *
+ * Only one context may push and only one may pop or drain.
+ */
+class ObservationQueue {
+
+  public:
+
+    /**
+     * Constructs an empty queue.
+     */
+    ObservationQueue();
+
+    /**
+     * Producer side: queues a reading. Returns false, and counts the
+     * reading as dropped, if the queue is full.
+     */
+    boolean push(const Observation& observation);
+    boolean pushCell(uint8_t x, uint8_t y, uint8_t value);
+    boolean pushRange(uint8_t x, uint8_t y, int16_t angle, uint16_t range, uint8_t value);
+
+    /**
+     * Consumer side: takes the oldest reading off the queue. Returns false
+     * if the queue is empty.
+     */
+    boolean pop(Observation& observation);
+
+    /**
+     * Consumer side: applies every queued reading to the map in one pass
+     * and reports whether the changes affect the plan held in the field
+     * for a robot at robotX, robotY. Returns one of the OBSERVATIONS_
+     * constants.
+     */
+    uint8_t drain(Map& map, DistanceField& plan, uint8_t robotX, uint8_t robotY);
+
+    /**
+     * Consumer side: as above, but checks the changes against a path
+     * rather than a field, looking only at the cells that changed.
+     * Returns one of the PATH_ constants (see Path::check()); for
+     * PATH_REPAIR, repairFrom is the earliest cell to repair from.
+     */
+    uint8_t drain(Map& map, Path& path, uint16_t& repairFrom);
+
+    /**
+     * Gets the number of readings dropped because the queue was full.
+     */
+    uint16_t getDropped();
+
+  private:
+
+    boolean apply(Map& map, Observation& observation, uint8_t& x, uint8_t& y);
+    boolean wallOnPath(Map& map, DistanceField& plan, uint8_t robotX, uint8_t robotY);
+
+    Observation mRing[OBSERVATION_QUEUE_SIZE];
+    uint8_t mHead;
+    uint8_t mTail;
+    uint16_t mDropped;
+};
+
+#endif
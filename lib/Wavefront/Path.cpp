@@ -0,0 +1,210 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "Path.h"
+
+/*
+ * Moves are packed four to a byte as direction - 1. Once the robot has
+ * made some of them, the remaining ones start at slot mFirst.
+ */
+
+static void step(uint8_t direction, uint8_t& x, uint8_t& y) {
+  switch (direction) {
+    case DOWN: x++; break;
+    case UP: x--; break;
+    case RIGHT: y++; break;
+    case LEFT: y--; break;
+  }
+}
+
+static boolean blocked(uint8_t value) {
+  return value == WALL || value == UNKNOWN;
+}
+
+Path::Path() {
+  clear();
+}
+
+void Path::clear() {
+  mStartX = mStartY = 0xff;
+  mGoalX = mGoalY = 0xff;
+  mFirst = 0;
+  mLength = 0;
+  mCells.clear();
+}
+
+boolean Path::extract(DistanceField& field, uint8_t startX, uint8_t startY) {
+  clear();
+  mStartX = startX;
+  mStartY = startY;
+  mGoalX = field.getGoalX();
+  mGoalY = field.getGoalY();
+  mCells.add(startX, startY);
+
+  uint8_t value = field.getValue(startX, startY);
+  if (value == NOTHING || blocked(value) || ! follow(field, startX, startY)) {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+uint16_t Path::getLength() {
+  return mLength;
+}
+
+uint8_t Path::getDirection(uint16_t index) {
+  if (index >= mLength) {
+    return NOTHING;
+  }
+  return getMove(mFirst + index);
+}
+
+uint8_t Path::getStartX() {
+  return mStartX;
+}
+
+uint8_t Path::getStartY() {
+  return mStartY;
+}
+
+uint8_t Path::getGoalX() {
+  return mGoalX;
+}
+
+uint8_t Path::getGoalY() {
+  return mGoalY;
+}
+
+boolean Path::contains(uint8_t x, uint8_t y) {
+  return mCells.contains(x, y);
+}
+
+void Path::advance() {
+  if (mLength == 0) {
+    return;
+  }
+  mCells.remove(mStartX, mStartY);
+  step(getDirection(0), mStartX, mStartY);
+  mFirst++;
+  mLength--;
+}
+
+uint8_t Path::check(Map& map, uint8_t x, uint8_t y, uint16_t& repairFrom) {
+  if (! mCells.contains(x, y) || ! blocked(map.getValue(x, y))) {
+    return PATH_VALID;
+  }
+
+  // Only now is it worth finding where along the path the cell is
+  uint8_t cellX = mStartX;
+  uint8_t cellY = mStartY;
+  uint16_t index = 0;
+  while (index < mLength && (cellX != x || cellY != y)) {
+    step(getDirection(index++), cellX, cellY);
+  }
+
+  if (index == 0 || index >= mLength) {
+    return PATH_REPLAN;
+  }
+  repairFrom = index - 1;
+  return PATH_REPAIR;
+}
+
+boolean Path::repair(Map& map, uint16_t repairFrom, DistanceField& field, CellQueue& queue) {
+  if (repairFrom > mLength) {
+    return false;
+  }
+
+  // Move the moves being kept to the front, and re-mark their cells
+  for (uint16_t i=0; i<repairFrom; i++) {
+    setMove(i, getMove(mFirst + i));
+  }
+  mFirst = 0;
+  mLength = repairFrom;
+  mCells.clear();
+
+  uint8_t x = mStartX;
+  uint8_t y = mStartY;
+  mCells.add(x, y);
+  for (uint16_t i=0; i<repairFrom; i++) {
+    step(getDirection(i), x, y);
+    mCells.add(x, y);
+  }
+
+  if (! field.computeUntil(map, mGoalX, mGoalY, queue, x, y) || ! follow(field, x, y)) {
+    clear();
+    return false;
+  }
+  cutLoops();
+  return true;
+}
+
+/*
+ * The new tail follows a new field, which can lead it back through cells
+ * of the moves kept. Each time the path comes back to a cell it has
+ * already been through, the moves in between are dropped, so that no
+ * cell is visited twice; advance() relies on this when it takes the
+ * robot's cell off the bitmap. The bitmap is rebuilt on the way.
+ */
+void Path::cutLoops() {
+  boolean cut;
+  do {
+    cut = false;
+    mCells.clear();
+
+    uint8_t x = mStartX;
+    uint8_t y = mStartY;
+    mCells.add(x, y);
+    uint16_t index = 0;
+    while (index < mLength) {
+      step(getDirection(index++), x, y);
+      if (mCells.contains(x, y)) {
+        cut = true;
+        break;
+      }
+      mCells.add(x, y);
+    }
+    if (! cut) {
+      return;
+    }
+
+    // Find where the path was first at x, y, and carry on from there
+    uint8_t firstX = mStartX;
+    uint8_t firstY = mStartY;
+    uint16_t first = 0;
+    while (firstX != x || firstY != y) {
+      step(getDirection(first++), firstX, firstY);
+    }
+    for (uint16_t i=index; i<mLength; i++) {
+      setMove(mFirst + first + i - index, getMove(mFirst + i));
+    }
+    mLength -= index - first;
+  } while (cut);
+}
+
+/*
+ * Appends the moves down the field from x, y to the goal.
+ */
+boolean Path::follow(DistanceField& field, uint8_t x, uint8_t y) {
+  while (x != mGoalX || y != mGoalY) {
+    uint8_t direction = field.directionFrom(x, y);
+    if (direction == NOTHING || mFirst + mLength >= CELL_COUNT) {
+      return false;
+    }
+    setMove(mFirst + mLength++, direction);
+    step(direction, x, y);
+    mCells.add(x, y);
+  }
+  return true;
+}
+
+uint8_t Path::getMove(uint16_t slot) {
+  return ((mMoves[slot >> 2] >> ((slot & 3) * 2)) & 3) + 1;
+}
+
+void Path::setMove(uint16_t slot, uint8_t direction) {
+  uint8_t shift = (slot & 3) * 2;
+  mMoves[slot >> 2] = (mMoves[slot >> 2] & ~(3 << shift)) | ((direction - 1) << shift);
+}
@@ -0,0 +1,122 @@
+#ifndef _Path_h_
+#define _Path_h_
+
+/**
+ * These manifest constants are the results of checking a planned path
+ * against a map update:
+ *
+ * PATH_VALID  - The update does not touch the path; keep following it.
+ * PATH_REPAIR - The path is blocked part way along. The robot can still
+ *               follow it up to the cell before the blockage, and only
+ *               the rest needs planning again (see Path::repair()).
+ * PATH_REPLAN - The robot's own cell or the goal is blocked; plan again
+ *               from scratch.
+ */
+#define PATH_VALID (uint8_t)0
+#define PATH_REPAIR (uint8_t)1
+#define PATH_REPLAN (uint8_t)2
+
+class Map;
+
+class CellQueue;
+
+class DistanceField;
+
+/**
+ * A planned route from the robot to the goal, kept as a sequence of
+ * directions together with a bitmap of the grid cells it passes through.
+ * After a map update, checking whether the route is still good only
+ * needs the updated cells, so the robot can keep following it instead of
+ * propagating the whole wave again after every move.
+ *
+ * Cells along the path are numbered from 0 (the robot) to getLength()
+ * (the goal); direction i leads from cell i to cell i + 1.
+ */
+class Path {
+
+  public:
+
+    /**
+     * Constructs an empty path.
+     */
+    Path();
+
+    /**
+     * Forgets the path.
+     */
+    void clear();
+
+    /**
+     * Follows the field from the start location down to its goal and
+     * remembers the way. Returns false, leaving the path empty, if the
+     * start cannot reach the goal.
+     */
+    boolean extract(DistanceField& field, uint8_t startX, uint8_t startY);
+
+    /**
+     * Gets the number of moves from the start to the goal.
+     */
+    uint16_t getLength();
+
+    /**
+     * Gets the direction of move number index, or NOTHING past the end.
+     */
+    uint8_t getDirection(uint16_t index);
+
+    /**
+     * Gets the location of the start (the robot) and of the goal.
+     */
+    uint8_t getStartX();
+    uint8_t getStartY();
+    uint8_t getGoalX();
+    uint8_t getGoalY();
+
+    /**
+     * Returns true if the path passes through the grid cell.
+     */
+    boolean contains(uint8_t x, uint8_t y);
+
+    /**
+     * Drops the first move, once the robot has made it.
+     */
+    void advance();
+
+    /**
+     * Checks the path against the current value of a grid cell that has
+     * just been updated on the map, returning one of the PATH_ constants.
+     * For PATH_REPAIR, repairFrom is set to the number of the last cell
+     * before the blockage.
+     *
+     * Cells off the path are answered from the bitmap alone.
+     */
+    uint8_t check(Map& map, uint8_t x, uint8_t y, uint16_t& repairFrom);
+
+    /**
+     * Keeps the first repairFrom moves and plans the rest of the way to
+     * the goal again, propagating only as far as needed to reach cell
+     * repairFrom. If the new way doubles back through cells of the moves
+     * kept, the path is cut short there, so it never passes through a
+     * cell twice. The field and queue are scratch space. Returns false,
+     * leaving the path empty, if cell repairFrom can no longer reach the
+     * goal.
+     */
+    boolean repair(Map& map, uint16_t repairFrom, DistanceField& field, CellQueue& queue);
+
+  private:
+
+    boolean follow(DistanceField& field, uint8_t x, uint8_t y);
+    void cutLoops();
+    uint8_t getMove(uint16_t slot);
+    void setMove(uint16_t slot, uint8_t direction);
+
+    uint8_t mStartX;
+    uint8_t mStartY;
+    uint8_t mGoalX;
+    uint8_t mGoalY;
+    uint16_t mFirst;
+    uint16_t mLength;
+    uint8_t mMoves[(CELL_COUNT + 3) / 4];
+    CellSet mCells;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include <Arduino.h>
+#include "PlanArena.h"
+
+PlanArena::PlanArena(uint8_t *buffer, uint32_t size) {
+  mBuffer = buffer;
+  mSize = size;
+  mUsed = 0;
+  mPeak = 0;
+}
+
+void *PlanArena::take(uint32_t bytes) {
+  // Pad up to the next aligned address, wherever the buffer starts
+  uint32_t padding = (PLAN_ARENA_ALIGN - (uintptr_t)(mBuffer + mUsed) % PLAN_ARENA_ALIGN) %
+                     PLAN_ARENA_ALIGN;
+  if (bytes > mSize - mUsed || padding > mSize - mUsed - bytes) {
+    return NULL;
+  }
+
+  void *block = mBuffer + mUsed + padding;
+  mUsed += padding + bytes;
+  if (mUsed > mPeak) {
+    mPeak = mUsed;
+  }
+  return block;
+}
+
+uint32_t PlanArena::mark() {
+  return mUsed;
+}
+
+void PlanArena::release(uint32_t top) {
+  if (top < mUsed) {
+    mUsed = top;
+  }
+}
+
+void PlanArena::reset() {
+  mUsed = 0;
+}
+
+uint32_t PlanArena::getSize() {
+  return mSize;
+}
+
+uint32_t PlanArena::getUsed() {
+  return mUsed;
+}
+
+uint32_t PlanArena::getPeak() {
+  return mPeak;
+}
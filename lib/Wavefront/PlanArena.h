@@ -0,0 +1,86 @@
+#ifndef _PlanArena_h_
+#define _PlanArena_h_
+
+/**
+ * Every block PlanArena::take() hands out starts on a multiple of this
+ * many bytes.
+ */
+#ifndef PLAN_ARENA_ALIGN
+#define PLAN_ARENA_ALIGN 4
+#endif
+
+/**
+ * The most arena bytes a take() of the given size can use up, padding
+ * included. The worst-case arena sizes published by the planners are
+ * sums of these.
+ */
+#define PLAN_ARENA_SPACE(bytes) ((uint32_t)(bytes) + PLAN_ARENA_ALIGN - 1)
+
+/**
+ * Working memory for planners, carved out of a caller-supplied buffer
+ * so that planning never touches the heap. Blocks are taken in stack
+ * order: a planner notes mark() when it starts, takes what it needs and
+ * gives it all back with release(), so planners run one after the other
+ * can share one arena sized for the hungriest of them.
+ *
+ * Planners publish their worst case as a macro (TIMED_PLANNER_ARENA,
+ * COOPERATIVE_ARENA), so the buffer can be sized at compile time:
+ *
+ *   static uint8_t scratch[TIMED_PLANNER_ARENA];
+ *   PlanArena arena(scratch, sizeof(scratch));
+ */
+class PlanArena {
+
+  public:
+
+    /**
+     * Constructs an arena handing out the size bytes at buffer.
+     */
+    PlanArena(uint8_t *buffer, uint32_t size);
+
+    /**
+     * Takes a block of the given number of bytes, or returns NULL,
+     * taking nothing, if it does not fit.
+     */
+    void *take(uint32_t bytes);
+
+    /**
+     * Gets the current top of the arena, to be handed to release().
+     */
+    uint32_t mark();
+
+    /**
+     * Gives back every block taken since mark() returned top.
+     */
+    void release(uint32_t top);
+
+    /**
+     * Gives back every block.
+     */
+    void reset();
+
+    /**
+     * Gets the size of the buffer in bytes.
+     */
+    uint32_t getSize();
+
+    /**
+     * Gets the number of bytes in use, padding included.
+     */
+    uint32_t getUsed();
+
+    /**
+     * Gets the largest number of bytes ever in use at once, to check a
+     * buffer size against what the planners really needed.
+     */
+    uint32_t getPeak();
+
+  private:
+
+    uint8_t *mBuffer;
+    uint32_t mSize;
+    uint32_t mUsed;
+    uint32_t mPeak;
+};
+
+#endif
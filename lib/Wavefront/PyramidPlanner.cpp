@@ -0,0 +1,213 @@
+#include <Arduino.h>
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "PyramidPlanner.h"
+
+PyramidPlanner::PyramidPlanner() {
+  mBuilt = false;
+  mHash = 0;
+  mLevels = 0;
+  mFallbacks = 0;
+}
+
+uint8_t PyramidPlanner::plan(Map& map) {
+  Coordinate robot;
+  Coordinate goal;
+  if (! map.locateRobot(robot) || ! map.locateGoal(goal)) {
+    return NOTHING;
+  }
+  return plan(map, robot.getX(), robot.getY(), goal.getX(), goal.getY());
+}
+
+uint8_t PyramidPlanner::plan(Map& map,
+                             uint8_t robotX,
+                             uint8_t robotY,
+                             uint8_t goalX,
+                             uint8_t goalY) {
+  if (! map.coordinateInRange(robotX, robotY) ||
+      ! map.coordinateInRange(goalX, goalY) ||
+      blocked(map, 0, robotX, robotY) ||
+      blocked(map, 0, goalX, goalY)) {
+    return NOTHING;
+  }
+
+  if (! mBuilt ||
+      mHash != map.getObstacleHash() ||
+      mSizeX[0] != map.getSizeX() ||
+      mSizeY[0] != map.getSizeY()) {
+    build(map);
+  }
+
+  // Levels alternate between the two fields, so that each one can be
+  // refined from the path on the one above; level 0 ends up in
+  // mFields[0]. When a band does not connect, the same level is searched
+  // in full, and when that does not either, the level below it.
+  uint8_t level = mLevels;
+  boolean banded = false;
+  for (;;) {
+    boolean found;
+    if (banded) {
+      found = refine(map, level, robotX, robotY, goalX, goalY);
+    } else if (level > 0) {
+      found = search(map, level, robotX, robotY, goalX, goalY);
+    } else {
+      mFallbacks++;
+      found = mFields[0].computeUntil(map, goalX, goalY, mQueue, robotX, robotY);
+    }
+
+    if (found && level > 0) {
+      level--;
+      banded = true;
+    } else if (found || (! banded && level == 0)) {
+      break;
+    } else if (banded) {
+      banded = false;
+    } else {
+      level--;
+    }
+  }
+  return mFields[0].directionFrom(robotX, robotY);
+}
+
+DistanceField& PyramidPlanner::getField() {
+  return mFields[0];
+}
+
+uint32_t PyramidPlanner::getFallbacks() {
+  return mFallbacks;
+}
+
+/*
+ * Downsamples the map one level at a time, marking the parent of every
+ * blocked cell.
+ */
+void PyramidPlanner::build(Map& map) {
+  mBuilt = true;
+  mHash = map.getObstacleHash();
+  mSizeX[0] = map.getSizeX();
+  mSizeY[0] = map.getSizeY();
+
+  mLevels = 0;
+  while (mLevels < PYRAMID_LEVELS && (mSizeX[mLevels] > 1 || mSizeY[mLevels] > 1)) {
+    uint8_t level = ++mLevels;
+    mSizeX[level] = (mSizeX[level - 1] + 1) / 2;
+    mSizeY[level] = (mSizeY[level - 1] + 1) / 2;
+
+    CellSet& parents = mBlocked[level - 1];
+    parents.clear();
+    for (uint8_t x=0; x<mSizeX[level - 1]; x++) {
+      for (uint8_t y=0; y<mSizeY[level - 1]; y++) {
+        if (blocked(map, level - 1, x, y)) {
+          parents.add(x >> 1, y >> 1);
+        }
+      }
+    }
+  }
+}
+
+boolean PyramidPlanner::blocked(Map& map, uint8_t level, uint8_t x, uint8_t y) {
+  if (level == 0) {
+    uint8_t value = map.getValue(x, y);
+    return value == WALL || value == UNKNOWN;
+  }
+  return mBlocked[level - 1].contains(x, y);
+}
+
+/*
+ * Propagates over the whole of a downsampled level. The robot and goal
+ * blocks stay open even if they hold a wall, since the cells that matter
+ * inside them are not blocked.
+ */
+boolean PyramidPlanner::search(Map& map,
+                               uint8_t level,
+                               uint8_t robotX,
+                               uint8_t robotY,
+                               uint8_t goalX,
+                               uint8_t goalY) {
+  DistanceField& field = mFields[level & 1];
+  field.fill(mSizeX[level], mSizeY[level], NOTHING);
+  for (uint8_t x=0; x<mSizeX[level]; x++) {
+    for (uint8_t y=0; y<mSizeY[level]; y++) {
+      if (blocked(map, level, x, y)) {
+        field.placeValue(x, y, WALL);
+      }
+    }
+  }
+  field.placeValue(robotX >> level, robotY >> level, NOTHING);
+  field.placeValue(goalX >> level, goalY >> level, NOTHING);
+
+  return field.spreadUntil(goalX >> level, goalY >> level, mQueue,
+                           robotX >> level, robotY >> level);
+}
+
+/*
+ * Propagates over the level through the open cells under the band
+ * around the way from the robot to the goal on the level above; every
+ * other cell is treated as a wall. Each step along the coarse path only
+ * adds the leading edge of the square band around it.
+ */
+boolean PyramidPlanner::refine(Map& map,
+                               uint8_t level,
+                               uint8_t robotX,
+                               uint8_t robotY,
+                               uint8_t goalX,
+                               uint8_t goalY) {
+  DistanceField& coarse = mFields[(level + 1) & 1];
+  DistanceField& fine = mFields[level & 1];
+  fine.fill(mSizeX[level], mSizeY[level], WALL);
+
+  int16_t x = robotX >> (level + 1);
+  int16_t y = robotY >> (level + 1);
+  for (int16_t dx=-PYRAMID_BAND; dx<=PYRAMID_BAND; dx++) {
+    for (int16_t dy=-PYRAMID_BAND; dy<=PYRAMID_BAND; dy++) {
+      openBlock(map, level, x + dx, y + dy);
+    }
+  }
+
+  for (;;) {
+    uint8_t direction = coarse.directionFrom(x, y);
+    if (direction == NOTHING) {
+      break;
+    }
+    for (int16_t k=-PYRAMID_BAND; k<=PYRAMID_BAND; k++) {
+      switch (direction) {
+        case DOWN: openBlock(map, level, x + 1 + PYRAMID_BAND, y + k); break;
+        case UP: openBlock(map, level, x - 1 - PYRAMID_BAND, y + k); break;
+        case RIGHT: openBlock(map, level, x + k, y + 1 + PYRAMID_BAND); break;
+        case LEFT: openBlock(map, level, x + k, y - 1 - PYRAMID_BAND); break;
+      }
+    }
+    switch (direction) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+    }
+  }
+
+  fine.placeValue(robotX >> level, robotY >> level, NOTHING);
+  fine.placeValue(goalX >> level, goalY >> level, NOTHING);
+  return fine.spreadUntil(goalX >> level, goalY >> level, mQueue,
+                          robotX >> level, robotY >> level);
+}
+
+/*
+ * Opens the cells of the level that lie under one cell of the level
+ * above, unless they are blocked.
+ */
+void PyramidPlanner::openBlock(Map& map, uint8_t level, int16_t x, int16_t y) {
+  DistanceField& fine = mFields[level & 1];
+  if (x < 0 || y < 0) {
+    return;
+  }
+  for (int16_t cx=x*2; cx<x*2+2 && cx<mSizeX[level]; cx++) {
+    for (int16_t cy=y*2; cy<y*2+2 && cy<mSizeY[level]; cy++) {
+      if (! blocked(map, level, cx, cy)) {
+        fine.placeValue(cx, cy, NOTHING);
+      }
+    }
+  }
+}
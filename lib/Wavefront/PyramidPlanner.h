@@ -0,0 +1,105 @@
+#ifndef _PyramidPlanner_h_
+#define _PyramidPlanner_h_
+
+/**
+ * The number of downsampled levels above the map. Each level halves the
+ * map in both directions, so the coarsest one has 1 / 4^PYRAMID_LEVELS
+ * of the map's cells.
+ */
+#ifndef PYRAMID_LEVELS
+#define PYRAMID_LEVELS 3
+#endif
+
+/**
+ * How many coarse cells either side of the coarse path are searched at
+ * the next finer level.
+ */
+#ifndef PYRAMID_BAND
+#define PYRAMID_BAND 1
+#endif
+
+class Map;
+
+/**
+ * Plans coarse-to-fine over a pyramid of downsampled occupancy grids. A
+ * cell on one level stands for a 2x2 block of the level below and is
+ * blocked if any cell of the block is. The way from the robot to the
+ * goal is found on the coarsest level first; each finer level then only
+ * propagates through the cells under a band of PYRAMID_BAND coarse cells
+ * around the path above, so a long corridor costs about its own length
+ * rather than the whole map.
+ *
+ * Blocking a whole block for one wall can close off narrow passages on
+ * the coarse levels. When the band on a level fails to connect robot
+ * and goal, that level is searched in full; when a full search fails,
+ * planning starts over one level finer, down to a full propagation over
+ * the map itself. The resulting path is the shortest one inside the
+ * band, which is not always the shortest one on the map.
+ *
+ * The pyramid is rebuilt only when the map's obstacle hash changes.
+ */
+class PyramidPlanner {
+
+  public:
+
+    /**
+     * Constructs a planner with no pyramid built yet.
+     */
+    PyramidPlanner();
+
+    /**
+     * Returns the direction in which the ROBOT should move to reach the
+     * GOAL, or NOTHING if either is missing from the map or there is no
+     * path between them. The map is left untouched.
+     */
+    uint8_t plan(Map& map);
+
+    /**
+     * As PyramidPlanner::plan(), but between the given locations.
+     * Afterwards getField() holds the distances to the goal, at least
+     * along the way from the robot.
+     */
+    uint8_t plan(Map& map, uint8_t robotX, uint8_t robotY, uint8_t goalX, uint8_t goalY);
+
+    /**
+     * Gets the full-resolution field of the last plan. Outside the band
+     * searched cells hold WALL.
+     */
+    DistanceField& getField();
+
+    /**
+     * Gets the number of plans that had to fall back to a full
+     * propagation over the map.
+     */
+    uint32_t getFallbacks();
+
+  private:
+
+    void build(Map& map);
+    boolean blocked(Map& map, uint8_t level, uint8_t x, uint8_t y);
+    boolean search(Map& map,
+                   uint8_t level,
+                   uint8_t robotX,
+                   uint8_t robotY,
+                   uint8_t goalX,
+                   uint8_t goalY);
+    boolean refine(Map& map,
+                   uint8_t level,
+                   uint8_t robotX,
+                   uint8_t robotY,
+                   uint8_t goalX,
+                   uint8_t goalY);
+    void openBlock(Map& map, uint8_t level, int16_t x, int16_t y);
+
+    boolean mBuilt;
+    uint32_t mHash;
+    uint8_t mSizeX[PYRAMID_LEVELS + 1];
+    uint8_t mSizeY[PYRAMID_LEVELS + 1];
+    uint8_t mLevels;
+    uint32_t mFallbacks;
+    CellSet mBlocked[PYRAMID_LEVELS];
+    DistanceField mFields[2];
+    CellQueue mQueue;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include "ReservationTable.h"
+
+ReservationTable::ReservationTable() {
+  clear();
+}
+
+void ReservationTable::clear() {
+  mCount = 0;
+}
+
+boolean ReservationTable::reserve(uint8_t x, uint8_t y, uint16_t from, uint16_t to) {
+  if (to > TIMED_HORIZON) {
+    to = TIMED_HORIZON;
+  }
+  if (from >= to) {
+    return true;
+  }
+  if (mCount == RESERVATION_TABLE_SIZE) {
+    return false;
+  }
+
+  Reservation& reservation = mReservations[mCount++];
+  reservation.x = x;
+  reservation.y = y;
+  reservation.from = from;
+  reservation.to = to;
+  return true;
+}
+
+boolean ReservationTable::isReserved(uint8_t x, uint8_t y, uint16_t time) {
+  for (uint8_t i=0; i<mCount; i++) {
+    Reservation& reservation = mReservations[i];
+    if (reservation.x == x && reservation.y == y &&
+        reservation.from <= time && time < reservation.to) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ReservationTable::safeInterval(uint8_t x,
+                                    uint8_t y,
+                                    uint16_t time,
+                                    uint16_t& start,
+                                    uint16_t& end) {
+  // Windows on the same cell may overlap or touch, so keep skipping
+  // past them until the start is free
+  start = time;
+  boolean moved = true;
+  while (moved) {
+    moved = false;
+    for (uint8_t i=0; i<mCount; i++) {
+      Reservation& reservation = mReservations[i];
+      if (reservation.x == x && reservation.y == y &&
+          reservation.from <= start && start < reservation.to) {
+        start = reservation.to;
+        moved = true;
+      }
+    }
+  }
+
+  end = SAFE_FOREVER;
+  for (uint8_t i=0; i<mCount; i++) {
+    Reservation& reservation = mReservations[i];
+    if (reservation.x == x && reservation.y == y &&
+        reservation.from > start && reservation.from < end) {
+      end = reservation.from;
+    }
+  }
+}
+
+void ReservationTable::advance(uint16_t steps) {
+  uint8_t kept = 0;
+  for (uint8_t i=0; i<mCount; i++) {
+    Reservation& reservation = mReservations[i];
+    if (reservation.to <= steps) {
+      continue;
+    }
+    reservation.from = reservation.from > steps ? reservation.from - steps : 0;
+    reservation.to -= steps;
+    mReservations[kept++] = reservation;
+  }
+  mCount = kept;
+}
+
+uint8_t ReservationTable::getCount() {
+  return mCount;
+}
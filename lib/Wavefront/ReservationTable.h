@@ -0,0 +1,96 @@
+#ifndef _ReservationTable_h_
+#define _ReservationTable_h_
+
+/**
+ * The number of (cell, time window) reservations a ReservationTable can
+ * hold.
+ */
+#ifndef RESERVATION_TABLE_SIZE
+#define RESERVATION_TABLE_SIZE 16
+#endif
+
+/**
+ * How many steps ahead reservations reach. Predictions further out than
+ * this are not worth planning around, so windows are cut off here and
+ * every cell is free from then on. Also bounds the length of the timed
+ * part of a TimedPlanner plan.
+ */
+#ifndef TIMED_HORIZON
+#define TIMED_HORIZON 32
+#endif
+
+/**
+ * The end of a safe interval that never ends.
+ */
+#define SAFE_FOREVER (uint16_t)0xffff
+
+/**
+ * One predicted occupation: grid cell x, y is taken from step from up
+ * to, but not including, step to.
+ */
+struct Reservation {
+  uint8_t x;
+  uint8_t y;
+  uint16_t from;
+  uint16_t to;
+};
+
+/**
+ * Short-horizon predictions of where moving obstacles (people, other
+ * vehicles) will be, as cells reserved for windows of time. Times are
+ * counted in robot steps from now: step 0 is where the robot is at the
+ * moment and step 1 is after its next move. Call advance() as the robot
+ * moves so that now stays now.
+ */
+class ReservationTable {
+
+  public:
+
+    /**
+     * Constructs an empty table.
+     */
+    ReservationTable();
+
+    /**
+     * Removes every reservation.
+     */
+    void clear();
+
+    /**
+     * Reserves grid cell x, y for steps from up to, but not including,
+     * to, cut off at TIMED_HORIZON. Returns false if the table is full.
+     * Windows that are empty after the cut are ignored.
+     */
+    boolean reserve(uint8_t x, uint8_t y, uint16_t from, uint16_t to);
+
+    /**
+     * Returns true if grid cell x, y is reserved at step time.
+     */
+    boolean isReserved(uint8_t x, uint8_t y, uint16_t time);
+
+    /**
+     * Finds the safe interval of grid cell x, y that contains step time,
+     * or the first one after it: start is the first free step at or
+     * after time and end is the next reserved step after that, or
+     * SAFE_FOREVER.
+     */
+    void safeInterval(uint8_t x, uint8_t y, uint16_t time, uint16_t& start, uint16_t& end);
+
+    /**
+     * Moves now on by the given number of steps, dropping windows that
+     * are over.
+     */
+    void advance(uint16_t steps);
+
+    /**
+     * Gets the number of reservations held.
+     */
+    uint8_t getCount();
+
+  private:
+
+    Reservation mReservations[RESERVATION_TABLE_SIZE];
+    uint8_t mCount;
+};
+
+#endif
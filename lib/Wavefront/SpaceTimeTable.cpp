@@ -0,0 +1,104 @@
+#include <Arduino.h>
+#include "SpaceTimeTable.h"
+
+SpaceTimeTable::SpaceTimeTable() {
+  clear();
+}
+
+void SpaceTimeTable::clear() {
+  for (uint16_t i=0; i<SPACE_TIME_SLOTS; i++) {
+    mSlots[i].used = false;
+  }
+  mCount = 0;
+  mLastTime = 0;
+}
+
+/*
+ * Finds the slot holding the key, or the empty slot where it would go.
+ * Linear probing; the load limit in hasRoom() keeps the runs short and
+ * guarantees an empty slot.
+ */
+SpaceTimeSlot *SpaceTimeTable::find(uint8_t x, uint8_t y, uint16_t time) {
+  uint32_t hash = ((uint32_t)x << 8 | y) * 0x9e3779b1UL ^ (uint32_t)time * 0x85ebca77UL;
+  hash ^= hash >> 16;
+
+  uint16_t index = hash & (SPACE_TIME_SLOTS - 1);
+  for (;;) {
+    SpaceTimeSlot& slot = mSlots[index];
+    if (! slot.used || (slot.x == x && slot.y == y && slot.time == time)) {
+      return &slot;
+    }
+    index = (index + 1) & (SPACE_TIME_SLOTS - 1);
+  }
+}
+
+boolean SpaceTimeTable::reserve(uint8_t x, uint8_t y, uint16_t time, uint8_t robot) {
+  SpaceTimeSlot *slot = find(x, y, time);
+  if (slot->used) {
+    return slot->robot == robot;
+  }
+  if (! hasRoom(1)) {
+    return false;
+  }
+
+  slot->x = x;
+  slot->y = y;
+  slot->time = time;
+  slot->since = time;
+  slot->robot = robot;
+  slot->used = true;
+  mCount++;
+  if (time > mLastTime) {
+    mLastTime = time;
+  }
+  return true;
+}
+
+boolean SpaceTimeTable::park(uint8_t x, uint8_t y, uint16_t since, uint8_t robot) {
+  SpaceTimeSlot *slot = find(x, y, SPACE_TIME_PARKED);
+  if (slot->used) {
+    return slot->robot == robot;
+  }
+  if (! hasRoom(1)) {
+    return false;
+  }
+
+  slot->x = x;
+  slot->y = y;
+  slot->time = SPACE_TIME_PARKED;
+  slot->since = since;
+  slot->robot = robot;
+  slot->used = true;
+  mCount++;
+  return true;
+}
+
+uint8_t SpaceTimeTable::owner(uint8_t x, uint8_t y, uint16_t time) {
+  SpaceTimeSlot *slot = find(x, y, time);
+  if (slot->used) {
+    return slot->robot;
+  }
+
+  slot = find(x, y, SPACE_TIME_PARKED);
+  if (slot->used && slot->since <= time) {
+    return slot->robot;
+  }
+  return NO_ROBOT;
+}
+
+uint16_t SpaceTimeTable::parkedSince(uint8_t x, uint8_t y) {
+  SpaceTimeSlot *slot = find(x, y, SPACE_TIME_PARKED);
+  return slot->used ? slot->since : SPACE_TIME_PARKED;
+}
+
+boolean SpaceTimeTable::hasRoom(uint16_t count) {
+  return (uint32_t)mCount + count <= (uint32_t)SPACE_TIME_SLOTS * 3 / 4;
+}
+
+uint16_t SpaceTimeTable::getCount() {
+  return mCount;
+}
+
+uint16_t SpaceTimeTable::getLastTime() {
+  return mLastTime;
+}
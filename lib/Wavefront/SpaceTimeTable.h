@@ -0,0 +1,106 @@
+#ifndef _SpaceTimeTable_h_
+#define _SpaceTimeTable_h_
+
+/**
+ * The number of (cell, step) reservations a SpaceTimeTable has room
+ * for. Must be a power of two, at most 32768; the table counts as full
+ * at three quarters of this.
+ */
+#ifndef SPACE_TIME_SLOTS
+#define SPACE_TIME_SLOTS 128
+#endif
+
+/**
+ * Returned by SpaceTimeTable::owner() for a cell nobody holds.
+ */
+#define NO_ROBOT (uint8_t)0xff
+
+/**
+ * The time of the slot held by a robot parked on a cell.
+ */
+#define SPACE_TIME_PARKED (uint16_t)0xffff
+
+/**
+ * One held cell. A parked robot holds its cell from step since onwards
+ * and has time SPACE_TIME_PARKED.
+ */
+struct SpaceTimeSlot {
+  uint8_t x;
+  uint8_t y;
+  uint16_t time;
+  uint16_t since;
+  uint8_t robot;
+  boolean used;
+};
+
+/**
+ * The cells held by a fleet of robots sharing one floor plan, keyed by
+ * (grid cell, step) in a hash table so that checking a cell at a step
+ * costs the same however many robots have committed paths. Robots that
+ * have reached their goal park there, holding the cell for every step
+ * from their arrival on.
+ */
+class SpaceTimeTable {
+
+  public:
+
+    /**
+     * Constructs an empty table.
+     */
+    SpaceTimeTable();
+
+    /**
+     * Releases every cell.
+     */
+    void clear();
+
+    /**
+     * Holds grid cell x, y at step time for the robot. Returns false if
+     * the table is full or another robot already holds it.
+     */
+    boolean reserve(uint8_t x, uint8_t y, uint16_t time, uint8_t robot);
+
+    /**
+     * Holds grid cell x, y for the robot from step since onwards.
+     * Returns false if the table is full or another robot is already
+     * parked there.
+     */
+    boolean park(uint8_t x, uint8_t y, uint16_t since, uint8_t robot);
+
+    /**
+     * Gets the robot holding grid cell x, y at step time, or NO_ROBOT.
+     */
+    uint8_t owner(uint8_t x, uint8_t y, uint16_t time);
+
+    /**
+     * Gets the step at which the robot parked on grid cell x, y holds
+     * it from, or SPACE_TIME_PARKED if nobody is parked there.
+     */
+    uint16_t parkedSince(uint8_t x, uint8_t y);
+
+    /**
+     * Returns true if the given number of further reservations fit.
+     */
+    boolean hasRoom(uint16_t count);
+
+    /**
+     * Gets the number of held slots.
+     */
+    uint16_t getCount();
+
+    /**
+     * Gets the last step any robot has reserved a cell for; every cell
+     * that is not parked on is free after it.
+     */
+    uint16_t getLastTime();
+
+  private:
+
+    SpaceTimeSlot *find(uint8_t x, uint8_t y, uint16_t time);
+
+    SpaceTimeSlot mSlots[SPACE_TIME_SLOTS];
+    uint16_t mCount;
+    uint16_t mLastTime;
+};
+
+#endif
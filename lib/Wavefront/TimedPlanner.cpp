@@ -0,0 +1,303 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "DistanceField.h"
+#include "ReservationTable.h"
+#include "PlanArena.h"
+#include "TimedPlanner.h"
+
+/*
+ * Returned by TimedPlanner::addNode() when there is no room left.
+ */
+#define NO_NODE 0xffff
+
+static const int8_t STEP_X[] = { 0, -1, 0, 1, 0 };
+static const int8_t STEP_Y[] = { 0, 0, 1, 0, -1 };
+
+TimedPlanner::TimedPlanner(PlanArena& arena) {
+  mMap = NULL;
+  mField = NULL;
+  mReservations = NULL;
+  mArena = &arena;
+  mNodes = NULL;
+  mHeap = NULL;
+  mNodeCount = 0;
+  mHeapCount = 0;
+  mExpanded = 0;
+  mFull = false;
+  mTimed = 0;
+  mLength = 0;
+  mTailX = 0xff;
+  mTailY = 0xff;
+}
+
+boolean TimedPlanner::plan(Map& map,
+                           DistanceField& field,
+                           ReservationTable& reservations,
+                           uint8_t robotX,
+                           uint8_t robotY) {
+  mMap = &map;
+  mField = &field;
+  mReservations = &reservations;
+  mNodeCount = 0;
+  mHeapCount = 0;
+  mExpanded = 0;
+  mFull = false;
+  mTimed = 0;
+  mLength = 0;
+
+  uint32_t top = mArena->mark();
+  mNodes = (TimedNode *)mArena->take(TIMED_PLANNER_NODES * sizeof(TimedNode));
+  mHeap = (uint16_t *)mArena->take(TIMED_PLANNER_NODES * sizeof(uint16_t));
+
+  boolean found = false;
+  if (mNodes == NULL || mHeap == NULL) {
+    mFull = true;
+  } else {
+    found = search(robotX, robotY);
+  }
+
+  mArena->release(top);
+  mNodes = NULL;
+  mHeap = NULL;
+  return found;
+}
+
+/*
+ * The search itself, in the nodes just taken from the arena.
+ */
+boolean TimedPlanner::search(uint8_t robotX, uint8_t robotY) {
+  uint8_t value = mField->getValue(robotX, robotY);
+  if (value == NOTHING || value == WALL || value == UNKNOWN) {
+    return false;
+  }
+
+  uint16_t start;
+  uint16_t end;
+  mReservations->safeInterval(robotX, robotY, 0, start, end);
+  if (start != 0) {
+    return false;
+  }
+
+  push(addNode(robotX, robotY, 0, end, NO_NODE));
+  while (mHeapCount > 0) {
+    uint16_t index = pop();
+    TimedNode& node = mNodes[index];
+    node.closed = true;
+
+    // Either at the goal for good, or past every reservation so that the
+    // field's way is free
+    boolean atGoal = node.x == mField->getGoalX() && node.y == mField->getGoalY();
+    if ((atGoal && node.end == SAFE_FOREVER) || node.time >= TIMED_HORIZON) {
+      finish(index);
+      return true;
+    }
+
+    mExpanded++;
+    expand(index);
+  }
+  return false;
+}
+
+/*
+ * Adds the node unless the cell's interval already has one that arrives
+ * no later; a later arrival is replaced in place.
+ */
+uint16_t TimedPlanner::addNode(uint8_t x, uint8_t y, uint16_t time, uint16_t end, uint16_t parent) {
+  uint16_t index = NO_NODE;
+  for (uint16_t i=0; i<mNodeCount; i++) {
+    TimedNode& node = mNodes[i];
+    if (node.x == x && node.y == y && node.end == end) {
+      if (node.closed || node.time <= time) {
+        return NO_NODE;
+      }
+      index = i;
+      break;
+    }
+  }
+
+  if (index == NO_NODE) {
+    if (mNodeCount == TIMED_PLANNER_NODES) {
+      mFull = true;
+      return NO_NODE;
+    }
+    index = mNodeCount++;
+  }
+
+  TimedNode& node = mNodes[index];
+  node.x = x;
+  node.y = y;
+  node.time = time;
+  node.end = end;
+  node.cost = time + mField->getValue(x, y) - GOAL;
+  node.parent = parent;
+  node.closed = false;
+  return index;
+}
+
+/*
+ * Tries every safe interval of every neighbour that can be reached by
+ * waiting here and then moving, before this cell's own interval ends.
+ */
+void TimedPlanner::expand(uint16_t index) {
+  TimedNode node = mNodes[index];
+
+  for (uint8_t direction=UP; direction<=LEFT; direction++) {
+    uint8_t x = node.x + STEP_X[direction];
+    uint8_t y = node.y + STEP_Y[direction];
+    uint8_t value = mField->getValue(x, y);
+    if (! mMap->coordinateInRange(x, y) ||
+        value == NOTHING || value == WALL || value == UNKNOWN) {
+      continue;
+    }
+
+    uint16_t arrive = node.time + 1;
+    while (arrive <= node.end) {
+      uint16_t start;
+      uint16_t end;
+      mReservations->safeInterval(x, y, arrive, start, end);
+      if (start > node.end) {
+        break;
+      }
+
+      // Step back a little later if arriving now means swapping places
+      // with whatever is coming the other way
+      uint16_t time = start;
+      while (time < end && time <= node.end &&
+             mReservations->isReserved(x, y, time - 1) &&
+             mReservations->isReserved(node.x, node.y, time)) {
+        time++;
+      }
+      if (time < end && time <= node.end) {
+        push(addNode(x, y, time, end, index));
+      }
+
+      if (end == SAFE_FOREVER) {
+        break;
+      }
+      arrive = end;
+    }
+  }
+}
+
+/*
+ * The open list is a binary heap ordered by cost, the later arrival
+ * first among equal costs so that the search dives towards the goal.
+ */
+boolean TimedPlanner::before(uint16_t a, uint16_t b) {
+  if (mNodes[a].cost != mNodes[b].cost) {
+    return mNodes[a].cost < mNodes[b].cost;
+  }
+  return mNodes[a].time > mNodes[b].time;
+}
+
+void TimedPlanner::push(uint16_t index) {
+  if (index == NO_NODE) {
+    return;
+  }
+
+  // A node replaced in place is already on the heap and only ever gets
+  // cheaper, so it just moves up from where it is
+  uint16_t child = mHeapCount;
+  for (uint16_t i=0; i<mHeapCount; i++) {
+    if (mHeap[i] == index) {
+      child = i;
+      break;
+    }
+  }
+  if (child == mHeapCount) {
+    mHeapCount++;
+  }
+
+  while (child > 0) {
+    uint16_t parent = (child - 1) / 2;
+    if (! before(index, mHeap[parent])) {
+      break;
+    }
+    mHeap[child] = mHeap[parent];
+    child = parent;
+  }
+  mHeap[child] = index;
+}
+
+uint16_t TimedPlanner::pop() {
+  uint16_t top = mHeap[0];
+  uint16_t last = mHeap[--mHeapCount];
+
+  uint16_t parent = 0;
+  for (;;) {
+    uint16_t child = parent * 2 + 1;
+    if (child >= mHeapCount) {
+      break;
+    }
+    if (child + 1 < mHeapCount && before(mHeap[child + 1], mHeap[child])) {
+      child++;
+    }
+    if (! before(mHeap[child], last)) {
+      break;
+    }
+    mHeap[parent] = mHeap[child];
+    parent = child;
+  }
+  mHeap[parent] = last;
+  return top;
+}
+
+/*
+ * Writes the moves from the robot to the final node, waits included,
+ * and remembers where the field takes over.
+ */
+void TimedPlanner::finish(uint16_t index) {
+  TimedNode& last = mNodes[index];
+  mTimed = last.time;
+  mLength = last.cost;
+  mTailX = last.x;
+  mTailY = last.y;
+
+  while (mNodes[index].parent != NO_NODE) {
+    TimedNode& node = mNodes[index];
+    TimedNode& parent = mNodes[node.parent];
+
+    uint8_t direction = UP;
+    while (parent.x + STEP_X[direction] != node.x || parent.y + STEP_Y[direction] != node.y) {
+      direction++;
+    }
+    mMoves[node.time - 1] = direction;
+    for (uint16_t t=parent.time; t<node.time-1; t++) {
+      mMoves[t] = WAIT;
+    }
+    index = node.parent;
+  }
+}
+
+uint16_t TimedPlanner::getLength() {
+  return mLength;
+}
+
+uint8_t TimedPlanner::getMove(uint16_t i) {
+  if (i >= mLength) {
+    return NOTHING;
+  }
+  if (i < mTimed) {
+    return mMoves[i];
+  }
+
+  // Past the horizon, follow the field
+  uint8_t x = mTailX;
+  uint8_t y = mTailY;
+  for (uint16_t t=mTimed; ; t++) {
+    uint8_t direction = mField->directionFrom(x, y);
+    if (t == i) {
+      return direction;
+    }
+    x += STEP_X[direction];
+    y += STEP_Y[direction];
+  }
+}
+
+uint16_t TimedPlanner::getExpanded() {
+  return mExpanded;
+}
+
+boolean TimedPlanner::getExhausted() {
+  return mFull;
+}
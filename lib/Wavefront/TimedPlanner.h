@@ -0,0 +1,129 @@
+#ifndef _TimedPlanner_h_
+#define _TimedPlanner_h_
+
+/**
+ * The number of search nodes a TimedPlanner can hold. A node is one safe
+ * interval of one grid cell reached by the search, so this, rather than
+ * grid x time, bounds the memory used.
+ */
+#ifndef TIMED_PLANNER_NODES
+#define TIMED_PLANNER_NODES 64
+#endif
+
+class Map;
+
+class DistanceField;
+
+class ReservationTable;
+
+class PlanArena;
+
+/**
+ * One safe interval of one grid cell reached by the search.
+ */
+struct TimedNode {
+  uint8_t x;
+  uint8_t y;
+  uint16_t time;
+  uint16_t end;
+  uint16_t cost;
+  uint16_t parent;
+  boolean closed;
+};
+
+/**
+ * The most PlanArena bytes TimedPlanner::plan() takes (see PlanArena.h).
+ */
+#define TIMED_PLANNER_ARENA (PLAN_ARENA_SPACE(TIMED_PLANNER_NODES * sizeof(TimedNode)) + \
+                             PLAN_ARENA_SPACE(TIMED_PLANNER_NODES * sizeof(uint16_t)))
+
+/**
+ * Plans around moving obstacles with safe-interval path planning (SIPP).
+ * The search runs over (grid cell, safe interval) pairs, where a safe
+ * interval is a stretch of steps during which the ReservationTable has
+ * no reservation on the cell, so a cell that is reserved once costs two
+ * nodes however long the robot may wait around it. The distance field
+ * to the goal over the static map serves as the A* heuristic.
+ *
+ * Reservations stop at TIMED_HORIZON, so once the search gets that far
+ * the rest of the way is simply the distance field's. The plan is a
+ * sequence of UP, RIGHT, DOWN, LEFT and WAIT moves.
+ *
+ * Moving obstacles are modelled by the cells they occupy at each step;
+ * a move is also ruled out if it swaps cells with a reservation (the
+ * robot's next cell reserved the step before it arrives and its current
+ * cell reserved the step it arrives).
+ */
+class TimedPlanner {
+
+  public:
+
+    /**
+     * Constructs a planner with no plan that searches in memory taken
+     * from the arena, given back before each plan() returns.
+     */
+    TimedPlanner(PlanArena& arena);
+
+    /**
+     * Plans from the robot's location to the goal of the field, which
+     * must be computed over the same map. Returns false if the goal
+     * cannot be reached, if the robot's own cell is reserved at step 0,
+     * or if the search ran out of nodes or arena.
+     */
+    boolean plan(Map& map,
+                 DistanceField& field,
+                 ReservationTable& reservations,
+                 uint8_t robotX,
+                 uint8_t robotY);
+
+    /**
+     * Gets the number of steps, waits included, of the last plan.
+     */
+    uint16_t getLength();
+
+    /**
+     * Gets move i of the last plan (a direction or WAIT), or NOTHING past
+     * its end.
+     */
+    uint8_t getMove(uint16_t i);
+
+    /**
+     * Gets the number of nodes the last plan expanded.
+     */
+    uint16_t getExpanded();
+
+    /**
+     * Returns true if the last plan ran out of nodes, or the arena could
+     * not hold them, in which case a failed plan does not mean that there
+     * is no way to the goal.
+     */
+    boolean getExhausted();
+
+  private:
+
+    boolean search(uint8_t robotX, uint8_t robotY);
+    uint16_t addNode(uint8_t x, uint8_t y, uint16_t time, uint16_t end, uint16_t parent);
+    void expand(uint16_t index);
+    void push(uint16_t index);
+    uint16_t pop();
+    boolean before(uint16_t a, uint16_t b);
+    void finish(uint16_t index);
+
+    Map *mMap;
+    DistanceField *mField;
+    ReservationTable *mReservations;
+    PlanArena *mArena;
+    TimedNode *mNodes;
+    uint16_t *mHeap;
+    uint16_t mNodeCount;
+    uint16_t mHeapCount;
+    uint16_t mExpanded;
+    boolean mFull;
+    uint8_t mMoves[TIMED_HORIZON];
+    uint16_t mTimed;
+    uint16_t mLength;
+    uint8_t mTailX;
+    uint8_t mTailY;
+};
+
+#endif
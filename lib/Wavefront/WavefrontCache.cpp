@@ -0,0 +1,91 @@
+#include <Arduino.h>
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "WavefrontCache.h"
+
+WavefrontCache::WavefrontCache() {
+  mHits = 0;
+  mMisses = 0;
+  invalidate();
+}
+
+uint8_t WavefrontCache::plan(Map& map) {
+  Coordinate robot;
+  Coordinate goal;
+  if (! map.locateRobot(robot) || ! map.locateGoal(goal)) {
+    return NOTHING;
+  }
+
+  DistanceField& field = lookup(map, goal.getX(), goal.getY());
+  uint8_t direction = field.directionFrom(robot.getX(), robot.getY());
+
+  // A field cached for other walls with the same hash can lead into a
+  // wall of this map; the step about to be taken is the one that matters
+  uint8_t x = robot.getX();
+  uint8_t y = robot.getY();
+  switch (direction) {
+    case DOWN: x++; break;
+    case UP: x--; break;
+    case RIGHT: y++; break;
+    case LEFT: y--; break;
+    default: return direction;
+  }
+  uint8_t value = map.getValue(x, y);
+  if (value == WALL || value == UNKNOWN) {
+    field.compute(map, goal.getX(), goal.getY(), mQueue);
+    direction = field.directionFrom(robot.getX(), robot.getY());
+  }
+  return direction;
+}
+
+DistanceField& WavefrontCache::lookup(Map& map, uint8_t goalX, uint8_t goalY) {
+  uint32_t hash = map.getObstacleHash();
+  uint8_t victim = 0;
+
+  mClock++;
+  for (uint8_t i=0; i<WAVEFRONT_CACHE_ENTRIES; i++) {
+    if (mValid[i] &&
+        mHashes[i] == hash &&
+        mFields[i].getGoalX() == goalX &&
+        mFields[i].getGoalY() == goalY &&
+        mFields[i].getSizeX() == map.getSizeX() &&
+        mFields[i].getSizeY() == map.getSizeY()) {
+      mHits++;
+      mLastUsed[i] = mClock;
+      return mFields[i];
+    }
+
+    // Prefer an empty entry, otherwise the least recently used one
+    if (! mValid[victim]) {
+      continue;
+    }
+    if (! mValid[i] || mLastUsed[i] < mLastUsed[victim]) {
+      victim = i;
+    }
+  }
+
+  mMisses++;
+  mFields[victim].compute(map, goalX, goalY, mQueue);
+  mHashes[victim] = hash;
+  mLastUsed[victim] = mClock;
+  mValid[victim] = true;
+  return mFields[victim];
+}
+
+void WavefrontCache::invalidate() {
+  mClock = 0;
+  for (uint8_t i=0; i<WAVEFRONT_CACHE_ENTRIES; i++) {
+    mValid[i] = false;
+    mLastUsed[i] = 0;
+  }
+}
+
+uint32_t WavefrontCache::getHits() {
+  return mHits;
+}
+
+uint32_t WavefrontCache::getMisses() {
+  return mMisses;
+}
@@ -0,0 +1,75 @@
+#ifndef _WavefrontCache_h_
+#define _WavefrontCache_h_
+
+/**
+ * The number of distance fields kept by a WavefrontCache. Each entry
+ * costs a little more than DEFAULT_X_SIZE x DEFAULT_Y_SIZE bytes, so keep
+ * this small on boards with little RAM.
+ */
+#ifndef WAVEFRONT_CACHE_ENTRIES
+#define WAVEFRONT_CACHE_ENTRIES 4
+#endif
+
+class Map;
+
+/**
+ * A small least-recently-used cache of fully propagated distance fields,
+ * keyed by the goal location, the map's size and its obstacle hash.
+ * Re-planning to the same goal against walls that have not changed
+ * since the last plan is then a lookup instead of a full propagation.
+ *
+ * Different walls can share a hash (see Map::getObstacleHash()), so a
+ * cached field may belong to other walls than the map's.
+ * WavefrontCache::plan() checks its answer against the map and
+ * propagates afresh if the first step is blocked.
+ */
+class WavefrontCache {
+
+  public:
+
+    /**
+     * Constructs an empty cache.
+     */
+    WavefrontCache();
+
+    /**
+     * Returns the direction in which the ROBOT should move to reach the
+     * GOAL, or NOTHING if either is missing from the map or there is no
+     * path between them. Unlike Map::propagateWavefront(), the map is
+     * left untouched.
+     */
+    uint8_t plan(Map& map);
+
+    /**
+     * Returns the distance field for the goal location on the map,
+     * propagating it only if it is not already cached. The returned
+     * field stays valid until the next call to this method. On a hash
+     * collision the field is that of the other walls; it is up to the
+     * caller to check the way it follows.
+     */
+    DistanceField& lookup(Map& map, uint8_t goalX, uint8_t goalY);
+
+    /**
+     * Forgets every cached field.
+     */
+    void invalidate();
+
+    /**
+     * Gets the number of lookups answered from (missing) the cache.
+     */
+    uint32_t getHits();
+    uint32_t getMisses();
+
+  private:
+
+    uint32_t mHits;
+    uint32_t mMisses;
+    uint32_t mClock;
+    uint32_t mHashes[WAVEFRONT_CACHE_ENTRIES];
+    uint32_t mLastUsed[WAVEFRONT_CACHE_ENTRIES];
+    boolean mValid[WAVEFRONT_CACHE_ENTRIES];
+    DistanceField mFields[WAVEFRONT_CACHE_ENTRIES];
+    CellQueue mQueue;
+};
+
+#endif
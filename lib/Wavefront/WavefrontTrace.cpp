@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "IWavefront.h"
+#include "WavefrontTrace.h"
+
+/*
+ * Folds signed deltas onto unsigned ones, small magnitudes first:
+ * 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+ */
+static uint32_t zigzag(int32_t value) {
+  return (uint32_t)value << 1 ^ (uint32_t)(value >> 31);
+}
+
+WavefrontTrace::WavefrontTrace(uint8_t *buffer, uint32_t size) {
+  mBuffer = buffer;
+  mSize = size;
+  reset();
+}
+
+void WavefrontTrace::reset() {
+  mLength = 0;
+  mStepStart = 0;
+  mSteps = 0;
+  mLastIndex = -1;
+  mLastValue = 0;
+  mSizeY = 0;
+  mStarted = false;
+  mOverflow = false;
+}
+
+void WavefrontTrace::wave(Map& map) {
+  if (mStarted) {
+    endStep();
+    return;
+  }
+
+  mStarted = true;
+  mSizeY = map.getSizeY();
+  if (mSize < WAVEFRONT_TRACE_HEADER) {
+    mOverflow = true;
+    return;
+  }
+  mBuffer[0] = WAVEFRONT_TRACE_MAGIC0;
+  mBuffer[1] = WAVEFRONT_TRACE_MAGIC1;
+  mBuffer[2] = WAVEFRONT_TRACE_VERSION;
+  mBuffer[3] = map.getSizeX();
+  mBuffer[4] = mSizeY;
+  mLength = WAVEFRONT_TRACE_HEADER;
+  mStepStart = mLength;
+
+  // The map as propagation found it
+  for (uint8_t x=0; x<map.getSizeX(); x++) {
+    for (uint8_t y=0; y<mSizeY; y++) {
+      uint8_t value = map.getValue(x, y);
+      if (value != NOTHING) {
+        cell(x, y, value);
+      }
+    }
+  }
+  endStep();
+}
+
+void WavefrontTrace::relabel(uint8_t x, uint8_t y, uint8_t value) {
+  if (mStarted) {
+    cell(x, y, value);
+  }
+}
+
+void WavefrontTrace::cell(uint8_t x, uint8_t y, uint8_t value) {
+  int32_t index = (int32_t)x * mSizeY + y;
+
+  put(zigzag(index - mLastIndex - 1) + 1);
+  put(zigzag((int32_t)value - mLastValue));
+  mLastIndex = index;
+  mLastValue = value;
+}
+
+void WavefrontTrace::endStep() {
+  put(0);
+  if (! mOverflow) {
+    mSteps++;
+    mStepStart = mLength;
+  }
+  mLastIndex = -1;
+  mLastValue = 0;
+}
+
+void WavefrontTrace::put(uint32_t value) {
+  if (mOverflow) {
+    return;
+  }
+
+  do {
+    if (mLength == mSize) {
+      // Keep only the steps that were finished
+      mOverflow = true;
+      mLength = mStepStart;
+      return;
+    }
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    mBuffer[mLength++] = value ? byte | 0x80 : byte;
+  } while (value);
+}
+
+uint32_t WavefrontTrace::getLength() {
+  return mLength;
+}
+
+uint16_t WavefrontTrace::getSteps() {
+  return mSteps;
+}
+
+boolean WavefrontTrace::getOverflow() {
+  return mOverflow;
+}
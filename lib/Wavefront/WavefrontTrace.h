@@ -0,0 +1,84 @@
+#ifndef _WavefrontTrace_h_
+#define _WavefrontTrace_h_
+
+/**
+ * Traces start with these bytes, followed by the map's X and Y sizes.
+ */
+#define WAVEFRONT_TRACE_MAGIC0 'W'
+#define WAVEFRONT_TRACE_MAGIC1 'T'
+#define WAVEFRONT_TRACE_VERSION 1
+#define WAVEFRONT_TRACE_HEADER 5
+
+class Map;
+
+/**
+ * Records Map::propagateWavefront() into a caller-supplied buffer, one
+ * step per wave() call, logging only the cells relabeled in each step.
+ * The first step is the map as it was before propagation (every cell
+ * that is not NOTHING).
+ *
+ * After the header, a step is a run of cells ended by a zero byte. Each
+ * cell is two varints (seven bits per byte, least significant first):
+ *
+ *   zigzag(index - previous index - 1) + 1
+ *   zigzag(value - previous value)
+ *
+ * where index is x * sizeY + y. Both deltas start over at every step
+ * (from index -1 and value 0), so a step that relabels a run of
+ * neighbouring cells costs about two bytes per cell.
+ *
+ * When the buffer fills up, the step being recorded is dropped and
+ * recording stops, so the buffer always holds whole steps.
+ * WavefrontTraceReader decodes the result.
+ */
+class WavefrontTrace : public IWavefront {
+
+  public:
+
+    /**
+     * Constructs a recorder writing into size bytes at buffer.
+     */
+    WavefrontTrace(uint8_t *buffer, uint32_t size);
+
+    /**
+     * Starts over with an empty buffer, ready for the next propagation.
+     */
+    void reset();
+
+    void wave(Map& map);
+    void relabel(uint8_t x, uint8_t y, uint8_t value);
+
+    /**
+     * Gets the number of bytes of the buffer in use.
+     */
+    uint32_t getLength();
+
+    /**
+     * Gets the number of whole steps recorded.
+     */
+    uint16_t getSteps();
+
+    /**
+     * Returns true if the buffer filled up and steps were lost.
+     */
+    boolean getOverflow();
+
+  private:
+
+    void cell(uint8_t x, uint8_t y, uint8_t value);
+    void endStep();
+    void put(uint32_t value);
+
+    uint8_t *mBuffer;
+    uint32_t mSize;
+    uint32_t mLength;
+    uint32_t mStepStart;
+    uint16_t mSteps;
+    int32_t mLastIndex;
+    uint8_t mLastValue;
+    uint8_t mSizeY;
+    boolean mStarted;
+    boolean mOverflow;
+};
+
+#endif
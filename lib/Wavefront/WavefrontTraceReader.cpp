@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include "IWavefront.h"
+#include "WavefrontTrace.h"
+#include "WavefrontTraceReader.h"
+
+static int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+WavefrontTraceReader::WavefrontTraceReader(const uint8_t *buffer, uint32_t length) {
+  mBuffer = buffer;
+  mLength = length;
+  mValid = length >= WAVEFRONT_TRACE_HEADER &&
+           buffer[0] == WAVEFRONT_TRACE_MAGIC0 &&
+           buffer[1] == WAVEFRONT_TRACE_MAGIC1 &&
+           buffer[2] == WAVEFRONT_TRACE_VERSION;
+  mSizeX = mValid ? buffer[3] : 0;
+  mSizeY = mValid ? buffer[4] : 0;
+  rewind();
+}
+
+void WavefrontTraceReader::rewind() {
+  mPosition = mValid ? WAVEFRONT_TRACE_HEADER : mLength;
+  mLastIndex = -1;
+  mLastValue = 0;
+}
+
+boolean WavefrontTraceReader::isValid() {
+  return mValid;
+}
+
+uint8_t WavefrontTraceReader::getSizeX() {
+  return mSizeX;
+}
+
+uint8_t WavefrontTraceReader::getSizeY() {
+  return mSizeY;
+}
+
+boolean WavefrontTraceReader::atEnd() {
+  return mPosition >= mLength;
+}
+
+boolean WavefrontTraceReader::nextCell(uint8_t& x, uint8_t& y, uint8_t& value) {
+  uint32_t token;
+  if (atEnd() || ! get(token)) {
+    return false;
+  }
+  if (token == 0) {
+    mLastIndex = -1;
+    mLastValue = 0;
+    return false;
+  }
+
+  uint32_t change;
+  if (! get(change)) {
+    return false;
+  }
+
+  token--;
+  int32_t index = mLastIndex + 1 + unzigzag(token);
+  int32_t next = mLastValue + unzigzag(change);
+  if (index < 0 || index >= (int32_t)mSizeX * mSizeY || next < 0 || next > 0xff) {
+    corrupt();
+    return false;
+  }
+
+  mLastIndex = index;
+  mLastValue = next;
+  x = index / mSizeY;
+  y = index % mSizeY;
+  value = next;
+  return true;
+}
+
+boolean WavefrontTraceReader::get(uint32_t& value) {
+  value = 0;
+  for (uint8_t shift=0; shift<35; shift+=7) {
+    if (mPosition >= mLength) {
+      corrupt();
+      return false;
+    }
+    uint8_t byte = mBuffer[mPosition++];
+    value |= (uint32_t)(byte & 0x7f) << shift;
+    if (! (byte & 0x80)) {
+      return true;
+    }
+  }
+  corrupt();
+  return false;
+}
+
+void WavefrontTraceReader::corrupt() {
+  mValid = false;
+  mPosition = mLength;
+}
@@ -0,0 +1,66 @@
+#ifndef _WavefrontTraceReader_h_
+#define _WavefrontTraceReader_h_
+
+/**
+ * Decodes a trace written by WavefrontTrace, a step at a time:
+ *
+ *   WavefrontTraceReader reader(buffer, length);
+ *   while (! reader.atEnd()) {
+ *     while (reader.nextCell(x, y, value)) {
+ *       // value was placed on x, y in this step
+ *     }
+ *     // end of step
+ *   }
+ */
+class WavefrontTraceReader {
+
+  public:
+
+    /**
+     * Constructs a reader over length bytes of trace at buffer. Check
+     * isValid() before reading.
+     */
+    WavefrontTraceReader(const uint8_t *buffer, uint32_t length);
+
+    /**
+     * Returns true if the buffer starts with a trace header this reader
+     * understands and nothing read so far was malformed.
+     */
+    boolean isValid();
+
+    uint8_t getSizeX();
+    uint8_t getSizeY();
+
+    /**
+     * Reads the next cell of the current step. Returns false, moving on
+     * to the next step, at the end of the step, and also at the end of
+     * the trace.
+     */
+    boolean nextCell(uint8_t& x, uint8_t& y, uint8_t& value);
+
+    /**
+     * Returns true once every step has been read.
+     */
+    boolean atEnd();
+
+    /**
+     * Goes back to the first step.
+     */
+    void rewind();
+
+  private:
+
+    boolean get(uint32_t& value);
+    void corrupt();
+
+    const uint8_t *mBuffer;
+    uint32_t mLength;
+    uint32_t mPosition;
+    int32_t mLastIndex;
+    uint8_t mLastValue;
+    uint8_t mSizeX;
+    uint8_t mSizeY;
+    boolean mValid;
+};
+
+#endif
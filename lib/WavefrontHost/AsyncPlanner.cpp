@@ -0,0 +1,236 @@
+#include <Arduino.h>
+#include <exception>
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "AsyncPlanner.h"
+
+void PlanLoop::start(PlanTask& task) {
+  post(task.mHandle);
+}
+
+void PlanLoop::post(std::coroutine_handle<> handle) {
+  mReady.push_back(handle);
+}
+
+bool PlanLoop::runOnce() {
+  if (mReady.empty()) {
+    return false;
+  }
+  std::coroutine_handle<> handle = mReady.front();
+  mReady.pop_front();
+  handle.resume();
+  return true;
+}
+
+uint32_t PlanLoop::run() {
+  uint32_t count = 0;
+  while (runOnce()) {
+    count++;
+  }
+  return count;
+}
+
+uint32_t PlanLoop::getPending() {
+  return mReady.size();
+}
+
+//-----------------------------------------------------------------------------
+
+PlanTask::promise_type::promise_type()
+  : result{ NOTHING, false, 0 },
+    detached(false) {
+}
+
+PlanTask PlanTask::promise_type::get_return_object() {
+  return PlanTask(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+/*
+ * Plans start suspended; the loop gives them their first slice.
+ */
+std::suspend_always PlanTask::promise_type::initial_suspend() noexcept {
+  return std::suspend_always();
+}
+
+PlanTask::FinalAwaiter PlanTask::promise_type::final_suspend() noexcept {
+  return FinalAwaiter();
+}
+
+void PlanTask::promise_type::return_value(PlanResult value) {
+  result = value;
+}
+
+void PlanTask::promise_type::unhandled_exception() {
+  std::terminate();
+}
+
+bool PlanTask::FinalAwaiter::await_ready() noexcept {
+  return false;
+}
+
+/*
+ * Hands straight over to whoever is awaiting the plan, without going
+ * back through the loop. Nobody will ever look at the result of a
+ * detached plan, so it frees itself here.
+ */
+std::coroutine_handle<> PlanTask::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+  promise_type& promise = handle.promise();
+  std::coroutine_handle<> next = promise.continuation;
+  if (! next) {
+    next = std::noop_coroutine();
+  }
+  if (promise.detached) {
+    handle.destroy();
+  }
+  return next;
+}
+
+void PlanTask::FinalAwaiter::await_resume() noexcept {
+}
+
+PlanTask::PlanTask(std::coroutine_handle<promise_type> handle)
+  : mHandle(handle) {
+}
+
+PlanTask::PlanTask(PlanTask&& other)
+  : mHandle(other.mHandle) {
+  other.mHandle = nullptr;
+}
+
+PlanTask& PlanTask::operator=(PlanTask&& other) {
+  if (this != &other) {
+    release();
+    mHandle = other.mHandle;
+    other.mHandle = nullptr;
+  }
+  return *this;
+}
+
+PlanTask::~PlanTask() {
+  release();
+}
+
+/*
+ * Frees a finished plan, or leaves one still under way to free itself
+ * when it finishes.
+ */
+void PlanTask::release() {
+  if (! mHandle) {
+    return;
+  }
+  if (mHandle.done()) {
+    mHandle.destroy();
+  } else {
+    mHandle.promise().detached = true;
+  }
+  mHandle = nullptr;
+}
+
+/*
+ * A task moved from holds no plan; it counts as done, with nothing to
+ * show for it.
+ */
+bool PlanTask::isDone() {
+  return ! mHandle || mHandle.done();
+}
+
+PlanResult PlanTask::getResult() {
+  if (! mHandle) {
+    return PlanResult{ NOTHING, false, 0 };
+  }
+  return mHandle.promise().result;
+}
+
+bool PlanTask::await_ready() {
+  return isDone();
+}
+
+/*
+ * The plan is already queued on its loop, so awaiting it only has to
+ * leave word where to carry on.
+ */
+void PlanTask::await_suspend(std::coroutine_handle<> awaiting) {
+  mHandle.promise().continuation = awaiting;
+}
+
+PlanResult PlanTask::await_resume() {
+  return getResult();
+}
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Suspends a plan to the back of the loop's queue.
+ */
+struct PlanYield {
+  PlanLoop& loop;
+
+  bool await_ready() {
+    return false;
+  }
+  void await_suspend(std::coroutine_handle<> handle) {
+    loop.post(handle);
+  }
+  void await_resume() {
+  }
+};
+
+AsyncPlanner::AsyncPlanner(PlanLoop& loop, uint16_t slice)
+  : mLoop(loop),
+    mSlice(slice),
+    mGeneration(0) {
+}
+
+PlanTask AsyncPlanner::plan(Map& map) {
+  Coordinate robot(0xff, 0xff);
+  Coordinate goal(0xff, 0xff);
+
+  // Without both there is nothing to reach; the wave starts empty and the
+  // plan finishes with NOTHING on its first slice
+  if (! map.locateRobot(robot) || ! map.locateGoal(goal)) {
+    robot = Coordinate(0xff, 0xff);
+    goal = Coordinate(0xff, 0xff);
+  }
+
+  mGeneration++;
+  mField.begin(map, goal.getX(), goal.getY(), mQueue, robot.getX(), robot.getY());
+
+  PlanTask task = run(mGeneration, robot.getX(), robot.getY());
+  mLoop.start(task);
+  return task;
+}
+
+/*
+ * The generation is checked every time the plan comes back from the
+ * loop, before it goes near the field, which a newer plan may have
+ * started over in the meantime.
+ */
+PlanTask AsyncPlanner::run(uint32_t generation, uint8_t robotX, uint8_t robotY) {
+  PlanResult result = { NOTHING, false, 0 };
+
+  for (;;) {
+    if (generation != mGeneration) {
+      result.cancelled = true;
+      co_return result;
+    }
+    result.slices++;
+    if (mField.resume(mQueue, mSlice)) {
+      break;
+    }
+    co_await PlanYield{ mLoop };
+  }
+
+  result.direction = mField.directionFrom(robotX, robotY);
+  co_return result;
+}
+
+void AsyncPlanner::cancel() {
+  mGeneration++;
+}
+
+DistanceField& AsyncPlanner::getField() {
+  return mField;
+}
@@ -0,0 +1,201 @@
+#ifndef _AsyncPlanner_h_
+#define _AsyncPlanner_h_
+
+#include <coroutine>
+#include <deque>
+
+/**
+ * The most grid cells an AsyncPlanner settles before it yields.
+ */
+#ifndef ASYNC_PLAN_SLICE
+#define ASYNC_PLAN_SLICE 256
+#endif
+
+class PlanTask;
+
+/**
+ * The outcome of a plan: the direction the robot should move in (NOTHING
+ * if it is on the goal or cannot reach it), whether a newer plan
+ * superseded it first, and the number of slices it ran for.
+ */
+struct PlanResult {
+  uint8_t direction;
+  bool cancelled;
+  uint16_t slices;
+};
+
+/**
+ * A single-threaded run queue for plans. The host's event loop calls
+ * runOnce() whenever it has nothing more urgent to do, and each call
+ * runs one slice of the oldest plan waiting, so no plan holds the loop
+ * for longer than a slice.
+ *
+ * A loop does not own what it queues. Destroying it while coroutines are
+ * still waiting leaks their frames, since a PlanTask may still refer to
+ * them; run() the loop dry first.
+ */
+class PlanLoop {
+
+  public:
+
+    /**
+     * Queues a plan, or any coroutine returning a PlanTask, to be run.
+     */
+    void start(PlanTask& task);
+
+    /**
+     * Queues a suspended coroutine to be resumed.
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * Resumes the oldest coroutine waiting. Returns false if there was
+     * none.
+     */
+    bool runOnce();
+
+    /**
+     * Keeps resuming until nothing is waiting and returns how many times
+     * it did.
+     */
+    uint32_t run();
+
+    /**
+     * Gets the number of coroutines waiting to be resumed.
+     */
+    uint32_t getPending();
+
+  private:
+
+    std::deque<std::coroutine_handle<> > mReady;
+};
+
+/**
+ * A plan that is under way. It can be polled with isDone() and
+ * getResult(), or awaited from another coroutine with co_await, which
+ * carries on from the point the plan finishes. Dropping a task that has
+ * not finished leaves it to finish, and free itself, in the loop.
+ */
+class PlanTask {
+
+  public:
+
+    struct FinalAwaiter;
+
+    struct promise_type {
+      PlanResult result;
+      std::coroutine_handle<> continuation;
+      bool detached;
+
+      promise_type();
+      PlanTask get_return_object();
+      std::suspend_always initial_suspend() noexcept;
+      FinalAwaiter final_suspend() noexcept;
+      void return_value(PlanResult value);
+      void unhandled_exception();
+    };
+
+    struct FinalAwaiter {
+      bool await_ready() noexcept;
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+      void await_resume() noexcept;
+    };
+
+    PlanTask(PlanTask&& other);
+    PlanTask(const PlanTask&) = delete;
+    PlanTask& operator=(const PlanTask&) = delete;
+
+    /**
+     * Takes over another task, dropping this one's plan first the same
+     * way the destructor does.
+     */
+    PlanTask& operator=(PlanTask&& other);
+    ~PlanTask();
+
+    /**
+     * Returns true once the plan has finished or been cancelled, and
+     * always for a task that has been moved from.
+     */
+    bool isDone();
+
+    /**
+     * Gets the outcome of a finished plan. A task that has been moved
+     * from gives NOTHING.
+     */
+    PlanResult getResult();
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> awaiting);
+    PlanResult await_resume();
+
+  private:
+
+    friend class PlanLoop;
+
+    explicit PlanTask(std::coroutine_handle<promise_type> handle);
+
+    void release();
+
+    std::coroutine_handle<promise_type> mHandle;
+};
+
+/**
+ * Plans a map's robot towards its goal a slice at a time on a PlanLoop,
+ * for hosts that are driven by events (sensor frames, messages, timers)
+ * rather than by a planning thread.
+ *
+ * Each plan is a coroutine that runs DistanceField::resume() for
+ * ASYNC_PLAN_SLICE cells, yields back to the loop, and carries on from
+ * the back of the queue. Starting a new plan supersedes every plan
+ * still under way: they notice the next time they run, before touching
+ * the field, and finish as cancelled, so a stale plan costs one empty
+ * resume rather than the rest of its wave. The planner's field and
+ * queue are shared by its plans for this reason; only the newest ever
+ * uses them.
+ *
+ * The map is copied into the field when the plan starts, so it can be
+ * updated as soon as plan() returns. The planner and its loop must
+ * outlive every plan they start.
+ *
+ * Host only: this needs C++20 coroutines, and each plan's coroutine
+ * frame comes from the heap.
+ */
+class AsyncPlanner {
+
+  public:
+
+    /**
+     * Constructs a planner that runs its plans on the loop, settling at
+     * most slice cells at a time.
+     */
+    AsyncPlanner(PlanLoop& loop, uint16_t slice = ASYNC_PLAN_SLICE);
+
+    /**
+     * Starts planning the map's robot towards its goal, cancelling any
+     * plan still under way, and queues the first slice on the loop.
+     */
+    PlanTask plan(Map& map);
+
+    /**
+     * Cancels every plan under way.
+     */
+    void cancel();
+
+    /**
+     * Gets the field of the newest plan. Once that plan is done, this
+     * holds the wave from the goal as far as the robot.
+     */
+    DistanceField& getField();
+
+  private:
+
+    PlanTask run(uint32_t generation, uint8_t robotX, uint8_t robotY);
+
+    PlanLoop& mLoop;
+    uint16_t mSlice;
+    uint32_t mGeneration;
+    CellQueue mQueue;
+    DistanceField mField;
+};
+
+#endif
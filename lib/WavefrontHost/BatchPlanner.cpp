@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include "Coordinate.h"
+#include "Map.h"
+#include "BatchPlanner.h"
+
+/*
+ * Cell x, y of lane l is mCells[((x + 1) * mStride + y + 1) * BATCH_LANES + l]
+ * where mStride = sizeY + 2; the border rows and columns are WALL. A
+ * lane with no robot or goal has NO_CELL for them.
+ */
+#define NO_CELL 0xffff
+
+BatchPlanner::BatchPlanner() {
+  mSizeX = 0;
+  mSizeY = 0;
+  mStride = 0;
+  mSweeps = 0;
+}
+
+boolean BatchPlanner::plan(Map **maps, uint16_t count, uint8_t *directions) {
+  mSweeps = 0;
+  if (count == 0) {
+    return true;
+  }
+
+  mSizeX = maps[0]->getSizeX();
+  mSizeY = maps[0]->getSizeY();
+  mStride = mSizeY + 2;
+  for (uint16_t i=1; i<count; i++) {
+    if (maps[i]->getSizeX() != mSizeX || maps[i]->getSizeY() != mSizeY) {
+      return false;
+    }
+  }
+
+  for (uint16_t first=0; first<count; first+=BATCH_LANES) {
+    uint8_t lanes = count - first < BATCH_LANES ? count - first : BATCH_LANES;
+
+    // Spare lanes are solid wall, so they never change
+    uint16_t cells = (mSizeX + 2) * mStride;
+    for (uint16_t i=0; i<cells * BATCH_LANES; i++) {
+      mCells[i] = WALL;
+    }
+    for (uint8_t lane=0; lane<BATCH_LANES; lane++) {
+      mRobot[lane] = NO_CELL;
+      mGoal[lane] = NO_CELL;
+    }
+
+    for (uint8_t lane=0; lane<lanes; lane++) {
+      load(lane, *maps[first + lane]);
+    }
+    propagate(lanes);
+    for (uint8_t lane=0; lane<lanes; lane++) {
+      directions[first + lane] = directionFrom(lane);
+    }
+  }
+  return true;
+}
+
+uint32_t BatchPlanner::getSweeps() {
+  return mSweeps;
+}
+
+void BatchPlanner::load(uint8_t lane, Map& map) {
+  for (uint8_t x=0; x<mSizeX; x++) {
+    uint8_t *cell = mCells + ((x + 1) * mStride + 1) * BATCH_LANES + lane;
+    for (uint8_t y=0; y<mSizeY; y++, cell+=BATCH_LANES) {
+      uint8_t value = map.getValue(x, y);
+      *cell = (value == WALL || value == UNKNOWN) ? WALL : NOTHING;
+    }
+  }
+
+  Coordinate robot;
+  Coordinate goal;
+  if (! map.locateRobot(robot) || ! map.locateGoal(goal)) {
+    return;
+  }
+  mRobot[lane] = (robot.getX() + 1) * mStride + robot.getY() + 1;
+  mGoal[lane] = (goal.getX() + 1) * mStride + goal.getY() + 1;
+  mCells[mGoal[lane] * BATCH_LANES + lane] = GOAL;
+}
+
+/*
+ * Sweep after sweep, every open cell next to a cell of the current
+ * level takes the next one. Cells labelled during a sweep hold the next
+ * level, not the current one, so labelling in place is safe, and each
+ * cell's label is its distance from the goal.
+ *
+ * A row of cells, border included, is one run of bytes, so each sweep
+ * is a single straight loop per row over all lanes at once. Cells next
+ * to each other in the run are the same cell of different maps, and
+ * the neighbours of byte i are i - BATCH_LANES, i + BATCH_LANES and the
+ * same byte of the rows either side. Border cells are WALL, so they are
+ * never labelled, and the rows outside the map are never swept.
+ */
+void BatchPlanner::propagate(uint8_t lanes) {
+  uint16_t width = mStride * BATCH_LANES;
+
+  for (uint8_t level=GOAL; level+1<RESET_MIN; level++) {
+    uint8_t next = level + 1;
+    uint8_t changed = 0;
+
+    for (uint8_t x=1; x<=mSizeX; x++) {
+      uint8_t *row = mCells + x * width;
+
+      // NOTHING is zero, so a cell is labelled by OR-ing in next. The
+      // labels go through a local array so that neither loop has to
+      // allow for its writes overlapping the cells it reads, which would
+      // keep the compiler from vectorizing it.
+      uint8_t labels[((uint16_t)DEFAULT_Y_SIZE + 2) * BATCH_LANES];
+      for (uint16_t i=0; i<width; i++) {
+        uint8_t reached = (row[i - width] == level) | (row[i + width] == level) |
+                          (row[i - BATCH_LANES] == level) | (row[i + BATCH_LANES] == level);
+        labels[i] = (uint8_t)-(reached & (row[i] == NOTHING)) & next;
+      }
+      for (uint16_t i=0; i<width; i++) {
+        row[i] |= labels[i];
+        changed |= labels[i];
+      }
+    }
+    mSweeps++;
+
+    if (! changed) {
+      return;
+    }
+
+    boolean waiting = false;
+    for (uint8_t lane=0; lane<lanes && ! waiting; lane++) {
+      waiting = mRobot[lane] != NO_CELL && mCells[mRobot[lane] * BATCH_LANES + lane] == NOTHING;
+    }
+    if (! waiting) {
+      return;
+    }
+  }
+}
+
+/*
+ * The neighbour of the robot closest to the goal, trying them in the
+ * same order as DistanceField::directionFrom().
+ */
+uint8_t BatchPlanner::directionFrom(uint8_t lane) {
+  if (mRobot[lane] == NO_CELL || mRobot[lane] == mGoal[lane]) {
+    return NOTHING;
+  }
+
+  // A robot the wave never reached, because it stopped short at
+  // RESET_MIN, has no way to the goal, whatever its neighbours hold
+  uint8_t value = mCells[mRobot[lane] * BATCH_LANES + lane];
+  if (value == NOTHING || value == WALL || value == UNKNOWN) {
+    return NOTHING;
+  }
+
+  const uint16_t neighbours[] = {
+    (uint16_t)(mRobot[lane] + mStride),
+    (uint16_t)(mRobot[lane] - mStride),
+    (uint16_t)(mRobot[lane] + 1),
+    (uint16_t)(mRobot[lane] - 1)
+  };
+  const uint8_t directions[] = { DOWN, UP, RIGHT, LEFT };
+
+  uint8_t minimum = RESET_MIN;
+  uint8_t direction = NOTHING;
+  for (uint8_t i=0; i<4; i++) {
+    uint8_t value = mCells[neighbours[i] * BATCH_LANES + lane];
+    if (value != NOTHING && value < minimum) {
+      minimum = value;
+      direction = directions[i];
+    }
+  }
+  return direction;
+}
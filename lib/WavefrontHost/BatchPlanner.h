@@ -0,0 +1,76 @@
+#ifndef _BatchPlanner_h_
+#define _BatchPlanner_h_
+
+/**
+ * The number of maps a BatchPlanner propagates in lockstep, one per
+ * byte lane. A multiple of the SIMD width (16 bytes for SSE2 and NEON)
+ * lets the compiler turn the inner loop into vector instructions.
+ */
+#ifndef BATCH_LANES
+#define BATCH_LANES 16
+#endif
+
+/**
+ * The number of grid cells a BatchPlanner holds for each lane: the
+ * largest map plus a one cell border of walls all round.
+ */
+#define BATCH_CELLS (((uint16_t)DEFAULT_X_SIZE + 2) * ((uint16_t)DEFAULT_Y_SIZE + 2))
+
+class Map;
+
+/**
+ * Plans many small maps of the same size at once, for simulations that
+ * step a crowd of independent environments. Up to BATCH_LANES maps at a
+ * time are interleaved cell by cell, so that one byte of each map's
+ * copy of a cell sits side by side, and the wave is propagated over all
+ * of them in the same pass: one level per sweep, labelling every open
+ * cell next to a cell of the previous level. The sweep has no branches
+ * per map and no range checks, thanks to the border of walls, and stops
+ * once every robot has been reached (or no map changes).
+ *
+ * Each map's direction is the one DistanceField::directionFrom() gives
+ * for its robot, which is a first step along a shortest path; as with
+ * Map::propagateWavefront(), WALL and UNKNOWN cells are blocked and a
+ * map without a path, a ROBOT or a GOAL gets NOTHING. The maps
+ * themselves are left untouched.
+ *
+ * Host only: the cells of all the lanes take BATCH_CELLS * BATCH_LANES
+ * bytes, already 2304 at 10x10, more than the board's whole SRAM.
+ */
+class BatchPlanner {
+
+  public:
+
+    /**
+     * Constructs a planner with nothing planned.
+     */
+    BatchPlanner();
+
+    /**
+     * Plans each of the count maps, writing the direction for maps[i]
+     * to directions[i]. All the maps must have the same size. Returns
+     * false, planning nothing, if they do not.
+     */
+    boolean plan(Map **maps, uint16_t count, uint8_t *directions);
+
+    /**
+     * Gets the number of sweeps the last plan() took over all batches.
+     */
+    uint32_t getSweeps();
+
+  private:
+
+    void load(uint8_t lane, Map& map);
+    void propagate(uint8_t lanes);
+    uint8_t directionFrom(uint8_t lane);
+
+    uint8_t mSizeX;
+    uint8_t mSizeY;
+    uint16_t mStride;
+    uint32_t mSweeps;
+    uint16_t mRobot[BATCH_LANES];
+    uint16_t mGoal[BATCH_LANES];
+    uint8_t mCells[BATCH_CELLS * BATCH_LANES];
+};
+
+#endif
@@ -0,0 +1,42 @@
+#include <Arduino.h>
+#include "Map.h"
+#include "MapSnapshots.h"
+
+/*
+ * mShared holds the index of the buffer that is neither being written
+ * nor read, plus this bit when it holds a publish the reader has not
+ * taken yet.
+ */
+#define FRESH 0x80
+#define INDEX_MASK 0x03
+
+MapSnapshots::MapSnapshots(uint8_t sizeX, uint8_t sizeY)
+  : mWorking(sizeX, sizeY),
+    mBuffers{ Map(sizeX, sizeY), Map(sizeX, sizeY), Map(sizeX, sizeY) },
+    mWriteIndex(0),
+    mReadIndex(1),
+    mShared(2) {
+}
+
+Map& MapSnapshots::working() {
+  return mWorking;
+}
+
+void MapSnapshots::publish() {
+  mBuffers[mWriteIndex] = mWorking;
+  uint8_t previous = mShared.exchange(mWriteIndex | FRESH, std::memory_order_acq_rel);
+  mWriteIndex = previous & INDEX_MASK;
+}
+
+bool MapSnapshots::refresh() {
+  if (! (mShared.load(std::memory_order_relaxed) & FRESH)) {
+    return false;
+  }
+  uint8_t previous = mShared.exchange(mReadIndex, std::memory_order_acq_rel);
+  mReadIndex = previous & INDEX_MASK;
+  return true;
+}
+
+Map& MapSnapshots::snapshot() {
+  return mBuffers[mReadIndex];
+}
@@ -0,0 +1,66 @@
+#ifndef _MapSnapshots_h_
+#define _MapSnapshots_h_
+
+#include <atomic>
+
+/**
+ * Lets one thread keep updating a map (typically sensor ingestion) while
+ * another plans against it, without either of them taking a lock.
+ *
+ * The writer edits its own working map and calls publish() whenever the
+ * map is in a consistent state. The planner calls refresh() before each
+ * plan to pick up the newest published map and then works on snapshot(),
+ * which nobody else touches until its next refresh(). The planner is free
+ * to call Map::propagateWavefront() on its snapshot.
+ *
+ * Internally this is a triple buffer: the writer and the reader each own
+ * one copy and the third, most recently published one, is handed between
+ * them with a single atomic exchange. There must be only one writer
+ * thread and one reader thread.
+ *
+ * Host only: this needs <atomic>.
+ */
+class MapSnapshots {
+
+  public:
+
+    /**
+     * Constructs the working map and every snapshot with the given size
+     * and all grid cells set to NOTHING.
+     */
+    MapSnapshots(uint8_t sizeX, uint8_t sizeY);
+
+    /**
+     * Writer side: the map to apply updates to. Changes are not seen by
+     * the planner until the next call to publish().
+     */
+    Map& working();
+
+    /**
+     * Writer side: makes the current state of the working map the newest
+     * snapshot. Costs one copy of the map; never blocks.
+     */
+    void publish();
+
+    /**
+     * Reader side: switches snapshot() over to the newest published map,
+     * if there is one the reader has not seen yet, and returns true if it
+     * did. Never blocks.
+     */
+    bool refresh();
+
+    /**
+     * Reader side: the map the planner currently owns.
+     */
+    Map& snapshot();
+
+  private:
+
+    Map mWorking;
+    Map mBuffers[3];
+    uint8_t mWriteIndex;
+    uint8_t mReadIndex;
+    std::atomic<uint8_t> mShared;
+};
+
+#endif
@@ -7,3 +7,10 @@ typedef int boolean;
 #include <math.h>
 #define PI M_PI
 #include <stdint.h>
+#include <string.h>
+
+/*
+ * Host builds have a single address space, so flash is plain memory.
+ */
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
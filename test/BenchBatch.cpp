@@ -0,0 +1,178 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "BatchPlanner.h"
+#include "MapCorpus.h"
+
+/**
+ * Benchmarks planning a crowd of small maps of one size, as a
+ * simulator stepping many environments does: one by one with
+ * Map::propagateWavefront() and with DistanceField, and in lockstep
+ * with BatchPlanner. Each result is written to stdout as a single JSON
+ * object per line:
+ *
+ *   ./benchbatch [--seed N] [--maps N] [--min-ms N]
+ *
+ * Every map of a run is generated with its own seed. agree counts the
+ * maps whose direction is the one DistanceField gives.
+ */
+
+using namespace std;
+
+/**
+ * A way of planning every map of the crowd, writing one direction per
+ * map.
+ */
+struct BatchEngine {
+  const char *name;
+  void (*plan)(Map **maps, uint16_t count, uint8_t *directions);
+};
+
+static void planWavefront(Map **maps, uint16_t count, uint8_t *directions) {
+  for (uint16_t i=0; i<count; i++) {
+    directions[i] = maps[i]->propagateWavefront(NULL);
+  }
+}
+
+static CellQueue benchQueue;
+static DistanceField benchField;
+
+static void planField(Map **maps, uint16_t count, uint8_t *directions) {
+  for (uint16_t i=0; i<count; i++) {
+    Coordinate robot;
+    Coordinate goal;
+    maps[i]->locateRobot(robot);
+    maps[i]->locateGoal(goal);
+    benchField.compute(*maps[i], goal.getX(), goal.getY(), benchQueue);
+    directions[i] = benchField.directionFrom(robot.getX(), robot.getY());
+  }
+}
+
+static BatchPlanner benchBatch;
+
+static void planBatch(Map **maps, uint16_t count, uint8_t *directions) {
+  benchBatch.plan(maps, count, directions);
+}
+
+static const BatchEngine ENGINES[] = {
+  { "wavefront", planWavefront },
+  { "field", planField },
+  { "batch", planBatch },
+  { NULL, NULL }
+};
+
+static const uint8_t SIZES[] = { 10, 16, 32, 0 };
+
+static const char *CASES[] = { "open", "clutter25", "maze", NULL };
+
+static void runCase(const BatchEngine& engine,
+                    const CorpusCase& corpusCase,
+                    uint8_t size,
+                    uint32_t seed,
+                    long minNanos,
+                    Map **maps,
+                    uint16_t count,
+                    uint8_t *directions,
+                    const uint8_t *expected) {
+  for (uint16_t i=0; i<count; i++) {
+    generateCorpusMap(*maps[i], corpusCase, seed + i);
+  }
+
+  engine.plan(maps, count, directions);
+  uint16_t agree = 0;
+  for (uint16_t i=0; i<count; i++) {
+    if (directions[i] == expected[i]) {
+      agree++;
+    }
+  }
+
+  long rounds = 0;
+  long elapsed = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  while (rounds < 3 || elapsed < minNanos) {
+    engine.plan(maps, count, directions);
+    rounds++;
+    elapsed = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start).count();
+  }
+
+  double nsPerPlan = (double)elapsed / rounds / count;
+
+  printf("{\"engine\":\"%s\",\"corpus\":\"%s\",\"size\":%u,\"seed\":%lu,\"maps\":%u,"
+         "\"lanes\":%u,\"rounds\":%ld,\"ns_per_plan\":%.1f,\"plans_per_s\":%.0f,"
+         "\"agree\":%u}\n",
+         engine.name, corpusCase.name, size, (unsigned long)seed, count,
+         BATCH_LANES, rounds, nsPerPlan, 1e9 / nsPerPlan, agree);
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t seed = 1;
+  unsigned count = 1024;
+  long minMillis = 200;
+
+  for (int i=1; i<argc; i++) {
+    if (! strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoul(argv[++i], NULL, 0);
+    } else if (! strcmp(argv[i], "--maps") && i + 1 < argc) {
+      count = strtoul(argv[++i], NULL, 0);
+    } else if (! strcmp(argv[i], "--min-ms") && i + 1 < argc) {
+      minMillis = strtol(argv[++i], NULL, 0);
+    } else {
+      fprintf(stderr, "usage: %s [--seed N] [--maps N] [--min-ms N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (count == 0 || count > 0xffff) {
+    fprintf(stderr, "--maps must be between 1 and 65535\n");
+    return 2;
+  }
+
+  Map **maps = new Map *[count];
+  uint8_t *directions = new uint8_t[count];
+  uint8_t *expected = new uint8_t[count];
+
+  for (const uint8_t *size = SIZES; *size; size++) {
+    if (*size > DEFAULT_X_SIZE || *size > DEFAULT_Y_SIZE) {
+      continue;
+    }
+    for (uint16_t i=0; i<count; i++) {
+      maps[i] = new Map(*size, *size);
+    }
+
+    for (const char **name = CASES; *name; name++) {
+      const CorpusCase *corpusCase = CORPUS_CASES;
+      while (strcmp(corpusCase->name, *name)) {
+        corpusCase++;
+      }
+
+      // DistanceField is the reference every engine is checked against
+      for (uint16_t i=0; i<count; i++) {
+        generateCorpusMap(*maps[i], *corpusCase, seed + i);
+      }
+      planField(maps, count, expected);
+
+      for (const BatchEngine *engine = ENGINES; engine->name; engine++) {
+        runCase(*engine, *corpusCase, *size, seed, minMillis * 1000000L,
+                maps, count, directions, expected);
+      }
+    }
+
+    for (uint16_t i=0; i<count; i++) {
+      delete maps[i];
+    }
+  }
+
+  delete[] expected;
+  delete[] directions;
+  delete[] maps;
+
+  return 0;
+}
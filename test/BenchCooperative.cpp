@@ -0,0 +1,205 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "SpaceTimeTable.h"
+#include "PlanArena.h"
+#include "CooperativePlanner.h"
+#include "MapCorpus.h"
+
+/**
+ * Benchmarks cooperative planning of a whole fleet on the generated map
+ * corpus. Every robot gets a goal and a start a few dozen cells from it,
+ * then the fleet is planned in priority order through one shared
+ * SpaceTimeTable, over and over, and each result is written to stdout as
+ * a single JSON object per line:
+ *
+ *   ./benchcooperative [--seed N] [--size N] [--min-ms N]
+ *
+ * The time per robot includes computing the distance field to its goal.
+ */
+
+using namespace std;
+
+/**
+ * How far, along each axis, a robot starts from its goal.
+ */
+#define BENCH_REACH 32
+
+/**
+ * The most robots in one fleet.
+ */
+#define BENCH_MAX_ROBOTS 100
+
+static const uint8_t FLEETS[] = { 10, 25, 50, 100, 0 };
+
+static const char *CASES[] = { "open", "clutter10", "clutter25", NULL };
+
+// Far too big for the stack
+static CellQueue benchQueue;
+static DistanceField benchField;
+static SpaceTimeTable benchTable;
+static uint8_t benchScratch[COOPERATIVE_ARENA];
+static PlanArena benchArena(benchScratch, sizeof(benchScratch));
+static CooperativePlanner benchPlanner(benchArena);
+
+static uint8_t startX[BENCH_MAX_ROBOTS];
+static uint8_t startY[BENCH_MAX_ROBOTS];
+static uint8_t goalX[BENCH_MAX_ROBOTS];
+static uint8_t goalY[BENCH_MAX_ROBOTS];
+
+static boolean taken(uint8_t robots, uint8_t x, uint8_t y) {
+  for (uint8_t i=0; i<robots; i++) {
+    if ((startX[i] == x && startY[i] == y) || (goalX[i] == x && goalY[i] == y)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static uint8_t near(CorpusRandom& random, uint8_t centre, uint8_t size) {
+  int16_t value = (int16_t)centre - BENCH_REACH + (int16_t)random.below(2 * BENCH_REACH + 1);
+  return value < 0 ? 0 : (value >= size ? size - 1 : value);
+}
+
+/*
+ * Picks a free goal for each robot, and a free start that can reach it.
+ */
+static void placeRobots(Map& map, uint8_t robots, uint32_t seed) {
+  CorpusRandom random(seed);
+  uint8_t size = map.getSizeX();
+
+  for (uint8_t i=0; i<robots; i++) {
+    startX[i] = startY[i] = goalX[i] = goalY[i] = 0xff;
+    for (;;) {
+      uint8_t x = random.below(size);
+      uint8_t y = random.below(size);
+      if (map.getValue(x, y) == WALL || taken(robots, x, y)) {
+        continue;
+      }
+      benchField.compute(map, x, y, benchQueue);
+
+      uint8_t fromX = near(random, x, size);
+      uint8_t fromY = near(random, y, size);
+      uint8_t value = benchField.getValue(fromX, fromY);
+      if (value == NOTHING || value == WALL || value == GOAL || taken(robots, fromX, fromY)) {
+        continue;
+      }
+      goalX[i] = x;
+      goalY[i] = y;
+      startX[i] = fromX;
+      startY[i] = fromY;
+      break;
+    }
+  }
+}
+
+/*
+ * Plans the whole fleet once, returning the number of robots planned.
+ */
+static uint8_t planFleet(Map& map, uint8_t robots, unsigned long& steps, unsigned long& expanded) {
+  uint8_t planned = 0;
+  benchTable.clear();
+  for (uint8_t i=0; i<robots; i++) {
+    benchField.compute(map, goalX[i], goalY[i], benchQueue);
+    if (benchPlanner.plan(map, benchField, benchTable, i, startX[i], startY[i])) {
+      planned++;
+      steps += benchPlanner.getLength();
+    }
+    expanded += benchPlanner.getExpanded();
+  }
+  return planned;
+}
+
+static void runCase(const CorpusCase& corpusCase,
+                    uint8_t size,
+                    uint8_t robots,
+                    uint32_t seed,
+                    long minNanos,
+                    Map& map) {
+  generateCorpusMap(map, corpusCase, seed);
+
+  // Only the walls matter; the fleet goes where the corpus put its robot
+  for (uint8_t x=0; x<size; x++) {
+    for (uint8_t y=0; y<size; y++) {
+      if (map.getValue(x, y) != WALL) {
+        map.placeValue(x, y, NOTHING);
+      }
+    }
+  }
+  placeRobots(map, robots, seed);
+
+  unsigned long steps = 0;
+  unsigned long expanded = 0;
+  uint8_t planned = planFleet(map, robots, steps, expanded);
+  double meanSteps = planned ? (double)steps / planned : 0;
+  double meanExpanded = (double)expanded / robots;
+
+  long fleets = 0;
+  long elapsed = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  while (fleets < 3 || elapsed < minNanos) {
+    planFleet(map, robots, steps, expanded);
+    fleets++;
+    elapsed = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start).count();
+  }
+
+  double nsPerRobot = (double)elapsed / fleets / robots;
+
+  printf("{\"engine\":\"cooperative\",\"corpus\":\"%s\",\"size\":%u,\"seed\":%lu,"
+         "\"robots\":%u,\"planned\":%u,\"failed\":%u,\"fleets\":%ld,"
+         "\"ns_per_robot\":%.1f,\"robots_per_s\":%.0f,\"mean_steps\":%.1f,"
+         "\"mean_expanded\":%.1f,\"reserved\":%u,\"bytes\":%lu}\n",
+         corpusCase.name, size, (unsigned long)seed, robots, planned,
+         robots - planned, fleets, nsPerRobot, 1e9 / nsPerRobot, meanSteps,
+         meanExpanded, benchTable.getCount(),
+         (unsigned long)(sizeof(Map) + sizeof(CellQueue) + sizeof(DistanceField) +
+                         sizeof(SpaceTimeTable) + sizeof(CooperativePlanner) +
+                         COOPERATIVE_ARENA));
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t seed = 1;
+  unsigned size = 254;
+  long minMillis = 200;
+
+  for (int i=1; i<argc; i++) {
+    if (! strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoul(argv[++i], NULL, 0);
+    } else if (! strcmp(argv[i], "--size") && i + 1 < argc) {
+      size = strtoul(argv[++i], NULL, 0);
+    } else if (! strcmp(argv[i], "--min-ms") && i + 1 < argc) {
+      minMillis = strtol(argv[++i], NULL, 0);
+    } else {
+      fprintf(stderr, "usage: %s [--seed N] [--size N] [--min-ms N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (size < 2 * BENCH_REACH || size > DEFAULT_X_SIZE || size > DEFAULT_Y_SIZE) {
+    fprintf(stderr, "size must be between %u and %u\n",
+            2 * BENCH_REACH, DEFAULT_X_SIZE < DEFAULT_Y_SIZE ? DEFAULT_X_SIZE : DEFAULT_Y_SIZE);
+    return 2;
+  }
+
+  // Large maps do not fit on the stack
+  Map *map = new Map(size, size);
+  for (const char **name = CASES; *name; name++) {
+    const CorpusCase *corpusCase = CORPUS_CASES;
+    while (strcmp(corpusCase->name, *name)) {
+      corpusCase++;
+    }
+    for (const uint8_t *robots = FLEETS; *robots; robots++) {
+      runCase(*corpusCase, size, *robots, seed, minMillis * 1000000L, *map);
+    }
+  }
+  delete map;
+
+  return 0;
+}
@@ -0,0 +1,237 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "Coordinate.h"
+#include "MinValueDirection.h"
+#include "IWavefront.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "WavefrontCache.h"
+#include "CellSet.h"
+#include "Path.h"
+#include "PyramidPlanner.h"
+#include "WavefrontTrace.h"
+#include "MapCorpus.h"
+
+/**
+ * Benchmarks the planning engines against the generated map corpus.
+ * Each result is written to stdout as a single JSON object per line so
+ * that runs can be diffed or loaded into a spreadsheet to track
+ * regressions:
+ *
+ *   ./benchwavefront [--seed N] [--max-size N] [--min-ms N]
+ *
+ * Map sizes are limited by the storage Map was compiled with
+ * (DEFAULT_X_SIZE x DEFAULT_Y_SIZE); see the bench target in the
+ * Makefile.
+ */
+
+using namespace std;
+
+/**
+ * A planning engine under test. plan() is handed a freshly generated
+ * map and returns the direction the robot should take. bytes() reports
+ * the memory the engine needs for a map of the given size, including
+ * the map itself: what it would take if compiled with storage of
+ * exactly that size, rather than the DEFAULT_X_SIZE x DEFAULT_Y_SIZE
+ * storage of the benchmark build.
+ */
+struct BenchEngine {
+  const char *name;
+  uint8_t (*plan)(Map& map);
+  unsigned long (*bytes)(Map& map);
+};
+
+/*
+ * The bytes of each structure for a map of the given number of cells:
+ * its fixed members plus its per-cell arrays cut down to that many
+ * cells.
+ */
+static unsigned long cellsOf(Map& map) {
+  return (unsigned long)map.getSizeX() * map.getSizeY();
+}
+
+static unsigned long mapBytes(unsigned long cells) {
+  return sizeof(Map) - MAP_LAYOUT_CELLS + cells;
+}
+
+static unsigned long fieldBytes(unsigned long cells) {
+  return sizeof(DistanceField) - MAP_LAYOUT_CELLS + cells;
+}
+
+static unsigned long queueBytes(unsigned long cells) {
+  return sizeof(CellQueue) - CELL_COUNT * sizeof(uint16_t) + cells * sizeof(uint16_t);
+}
+
+static unsigned long setBytes(unsigned long cells) {
+  return sizeof(CellSet) - (CELL_COUNT + 7) / 8 + (cells + 7) / 8;
+}
+
+static uint8_t planWavefront(Map& map) {
+  return map.propagateWavefront(NULL);
+}
+
+static unsigned long bytesWavefront(Map& map) {
+  return mapBytes(cellsOf(map));
+}
+
+// Room for a full trace of the slowest generated maps
+static uint8_t benchTraceBuffer[1 << 22];
+static WavefrontTrace benchTrace(benchTraceBuffer, sizeof(benchTraceBuffer));
+
+// The wavefront engine again, recording every step
+static uint8_t planTrace(Map& map) {
+  benchTrace.reset();
+  return map.propagateWavefront(&benchTrace);
+}
+
+static unsigned long bytesTrace(Map& map) {
+  return mapBytes(cellsOf(map)) + benchTrace.getLength();
+}
+
+// Engine state is far too big for the stack at the larger map sizes
+static CellQueue benchQueue;
+static DistanceField benchField;
+static WavefrontCache benchCache;
+
+static uint8_t planField(Map& map) {
+  Coordinate robot;
+  Coordinate goal;
+  map.locateRobot(robot);
+  map.locateGoal(goal);
+  benchField.compute(map, goal.getX(), goal.getY(), benchQueue);
+  return benchField.directionFrom(robot.getX(), robot.getY());
+}
+
+static unsigned long bytesField(Map& map) {
+  unsigned long cells = cellsOf(map);
+  return mapBytes(cells) + queueBytes(cells) + fieldBytes(cells);
+}
+
+// After the warm-up plan every re-plan is a cache hit
+static uint8_t planCache(Map& map) {
+  return benchCache.plan(map);
+}
+
+static unsigned long bytesCache(Map& map) {
+  unsigned long cells = cellsOf(map);
+  unsigned long fixed = sizeof(WavefrontCache) - WAVEFRONT_CACHE_ENTRIES * sizeof(DistanceField) -
+                        sizeof(CellQueue);
+  return mapBytes(cells) + fixed + WAVEFRONT_CACHE_ENTRIES * fieldBytes(cells) + queueBytes(cells);
+}
+
+// The pyramid is only rebuilt when the walls change, which they do not
+// between repeats
+static PyramidPlanner benchPyramid;
+
+static uint8_t planPyramid(Map& map) {
+  return benchPyramid.plan(map);
+}
+
+// One blocked set per downsampled level, each a quarter of the one below
+static unsigned long bytesPyramid(Map& map) {
+  unsigned long cells = cellsOf(map);
+  unsigned long bytes = mapBytes(cells) + sizeof(PyramidPlanner) -
+                        PYRAMID_LEVELS * sizeof(CellSet) - 2 * sizeof(DistanceField) -
+                        sizeof(CellQueue) + 2 * fieldBytes(cells) + queueBytes(cells);
+  unsigned long sizeX = map.getSizeX();
+  unsigned long sizeY = map.getSizeY();
+  for (uint8_t level=1; level<=PYRAMID_LEVELS && (sizeX > 1 || sizeY > 1); level++) {
+    sizeX = (sizeX + 1) / 2;
+    sizeY = (sizeY + 1) / 2;
+    bytes += setBytes(sizeX * sizeY);
+  }
+  return bytes;
+}
+
+static const BenchEngine ENGINES[] = {
+  { "wavefront", planWavefront, bytesWavefront },
+  { "trace", planTrace, bytesTrace },
+  { "field", planField, bytesField },
+  { "cache", planCache, bytesCache },
+  { "pyramid", planPyramid, bytesPyramid },
+  { NULL, NULL, NULL }
+};
+
+static const uint8_t SIZES[] = { 10, 16, 32, 64, 128, 254, 0 };
+
+#if MAP_LAYOUT == MAP_LAYOUT_TILED
+static const char LAYOUT[] = "tiled";
+#elif MAP_LAYOUT == MAP_LAYOUT_MORTON
+static const char LAYOUT[] = "morton";
+#else
+static const char LAYOUT[] = "rowmajor";
+#endif
+
+static void runCase(const BenchEngine& engine,
+                    const CorpusCase& corpusCase,
+                    uint8_t size,
+                    uint32_t seed,
+                    long minNanos,
+                    Map& map) {
+  generateCorpusMap(map, corpusCase, seed);
+
+  // Warm up and remember the answer so runs can be cross-checked
+  uint8_t direction = engine.plan(map);
+
+  long plans = 0;
+  long elapsed = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  while (plans < 3 || elapsed < minNanos) {
+    engine.plan(map);
+    plans++;
+    elapsed = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - start).count();
+  }
+
+  double nsPerPlan = (double)elapsed / plans;
+  double cells = (double)size * size;
+
+  printf("{\"engine\":\"%s\",\"layout\":\"%s\",\"corpus\":\"%s\",\"size\":%u,"
+         "\"seed\":%lu,\"plans\":%ld,\"ns_per_plan\":%.1f,\"cells_per_s\":%.0f,"
+         "\"bytes\":%lu,\"direction\":%u}\n",
+         engine.name, LAYOUT, corpusCase.name, size, (unsigned long)seed,
+         plans, nsPerPlan, cells * 1e9 / nsPerPlan,
+         engine.bytes(map), direction);
+  fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+  uint32_t seed = 1;
+  unsigned maxSize = 255;
+  long minMillis = 100;
+
+  for (int i=1; i<argc; i++) {
+    if (! strcmp(argv[i], "--seed") && i + 1 < argc) {
+      seed = strtoul(argv[++i], NULL, 0);
+    } else if (! strcmp(argv[i], "--max-size") && i + 1 < argc) {
+      maxSize = strtoul(argv[++i], NULL, 0);
+    } else if (! strcmp(argv[i], "--min-ms") && i + 1 < argc) {
+      minMillis = strtol(argv[++i], NULL, 0);
+    } else {
+      fprintf(stderr, "usage: %s [--seed N] [--max-size N] [--min-ms N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  for (const uint8_t *size = SIZES; *size; size++) {
+    if (*size > maxSize || *size > DEFAULT_X_SIZE || *size > DEFAULT_Y_SIZE) {
+      continue;
+    }
+
+    // Large maps do not fit on the stack
+    Map *map = new Map(*size, *size);
+    for (const CorpusCase *corpusCase = CORPUS_CASES; corpusCase->name; corpusCase++) {
+      for (const BenchEngine *engine = ENGINES; engine->name; engine++) {
+        runCase(*engine, *corpusCase, *size, seed, minMillis * 1000000L, *map);
+      }
+    }
+    delete map;
+  }
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+#include <Arduino.h>
+#include <vector>
+#include "Map.h"
+#include "MapCorpus.h"
+
+const CorpusCase CORPUS_CASES[] = {
+  { "open", CORPUS_OPEN, 0 },
+  { "clutter10", CORPUS_CLUTTER, 10 },
+  { "clutter25", CORPUS_CLUTTER, 25 },
+  { "clutter40", CORPUS_CLUTTER, 40 },
+  { "maze", CORPUS_MAZE, 0 },
+  { "spiral", CORPUS_SPIRAL, 0 },
+  { NULL, CORPUS_OPEN, 0 }
+};
+
+CorpusRandom::CorpusRandom(uint32_t seed) {
+  // xorshift must never be seeded with zero
+  mState = seed ? seed : 0x9e3779b9;
+}
+
+uint32_t CorpusRandom::next() {
+  mState ^= mState << 13;
+  mState ^= mState >> 17;
+  mState ^= mState << 5;
+  return mState;
+}
+
+uint32_t CorpusRandom::below(uint32_t bound) {
+  return next() % bound;
+}
+
+static void fill(Map& map, uint8_t value) {
+  for (uint8_t x=0; x<map.getSizeX(); x++) {
+    for (uint8_t y=0; y<map.getSizeY(); y++) {
+      map.placeValue(x, y, value);
+    }
+  }
+}
+
+static void generateClutter(Map& map, uint8_t density, CorpusRandom& random) {
+  for (uint8_t x=0; x<map.getSizeX(); x++) {
+    for (uint8_t y=0; y<map.getSizeY(); y++) {
+      map.placeValue(x, y, random.below(100) < density ? WALL : NOTHING);
+    }
+  }
+}
+
+/*
+ * Classic recursive backtracker, run iteratively: maze cells live on
+ * odd coordinates and the walls between them on even ones.
+ */
+static void generateMaze(Map& map, CorpusRandom& random) {
+  static const int8_t dx[] = { 2, -2, 0, 0 };
+  static const int8_t dy[] = { 0, 0, 2, -2 };
+
+  fill(map, WALL);
+
+  std::vector<uint16_t> stack;
+  map.placeValue(1, 1, NOTHING);
+  stack.push_back(1 << 8 | 1);
+
+  while (! stack.empty()) {
+    uint8_t x = stack.back() >> 8;
+    uint8_t y = stack.back() & 0xff;
+
+    uint8_t candidates[4];
+    uint8_t count = 0;
+    for (uint8_t d=0; d<4; d++) {
+      int nx = x + dx[d];
+      int ny = y + dy[d];
+      if (nx > 0 && ny > 0 && nx < map.getSizeX() - 1 && ny < map.getSizeY() - 1 &&
+          map.getValue(nx, ny) == WALL) {
+        candidates[count++] = d;
+      }
+    }
+
+    if (count == 0) {
+      stack.pop_back();
+      continue;
+    }
+
+    uint8_t d = candidates[random.below(count)];
+    map.placeValue(x + dx[d] / 2, y + dy[d] / 2, NOTHING);
+    map.placeValue(x + dx[d], y + dy[d], NOTHING);
+    stack.push_back((x + dx[d]) << 8 | (y + dy[d]));
+  }
+}
+
+/*
+ * Nested rectangular rings, each with a single gap that alternates
+ * between opposite corners, so the only route from the middle to the
+ * outside winds around every ring.
+ */
+static void generateSpiral(Map& map) {
+  uint8_t sizeX = map.getSizeX();
+  uint8_t sizeY = map.getSizeY();
+
+  fill(map, NOTHING);
+
+  uint8_t ring = 0;
+  for (uint8_t k=1; 2 * k + 2 < sizeX && 2 * k + 2 < sizeY; k += 2, ring++) {
+    uint8_t lastX = sizeX - 1 - k;
+    uint8_t lastY = sizeY - 1 - k;
+    for (uint8_t x=k; x<=lastX; x++) {
+      map.placeValue(x, k, WALL);
+      map.placeValue(x, lastY, WALL);
+    }
+    for (uint8_t y=k; y<=lastY; y++) {
+      map.placeValue(k, y, WALL);
+      map.placeValue(lastX, y, WALL);
+    }
+    if (ring % 2 == 0) {
+      map.placeValue(k, k + 1, NOTHING);
+    } else {
+      map.placeValue(lastX, lastY - 1, NOTHING);
+    }
+  }
+}
+
+void generateCorpusMap(Map& map, const CorpusCase& corpusCase, uint32_t seed) {
+  CorpusRandom random(seed);
+  uint8_t robotX = 0;
+  uint8_t robotY = 0;
+  uint8_t goalX = map.getSizeX() - 1;
+  uint8_t goalY = map.getSizeY() - 1;
+
+  switch (corpusCase.kind) {
+    case CORPUS_OPEN:
+      fill(map, NOTHING);
+      break;
+    case CORPUS_CLUTTER:
+      generateClutter(map, corpusCase.density, random);
+      break;
+    case CORPUS_MAZE:
+      generateMaze(map, random);
+      robotX = 1;
+      robotY = 1;
+      // The far corner cell of the maze, which is always carved
+      goalX = (map.getSizeX() - 2) | 1;
+      goalY = (map.getSizeY() - 2) | 1;
+      if (goalX >= map.getSizeX() - 1) goalX -= 2;
+      if (goalY >= map.getSizeY() - 1) goalY -= 2;
+      break;
+    case CORPUS_SPIRAL:
+      generateSpiral(map);
+      robotX = map.getSizeX() / 2;
+      robotY = map.getSizeY() / 2;
+      goalX = 0;
+      goalY = 0;
+      break;
+  }
+
+  map.placeValue(robotX, robotY, ROBOT);
+  map.placeValue(goalX, goalY, GOAL);
+}
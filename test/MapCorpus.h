@@ -0,0 +1,58 @@
+#ifndef _MapCorpus_h_
+#define _MapCorpus_h_
+
+/**
+ * Reproducible map generators used by the benchmarks. Every generator
+ * overwrites all grid cells of the map it is handed (within the map's
+ * logical size) and places a ROBOT and a GOAL, so the same kind, size
+ * and seed always yield the same map.
+ */
+enum CorpusKind {
+  CORPUS_OPEN,    // No obstacles, ROBOT and GOAL in opposite corners
+  CORPUS_CLUTTER, // Uniformly random WALL cells at a given density
+  CORPUS_MAZE,    // Recursive-backtracker maze on the odd cells
+  CORPUS_SPIRAL   // Nested rings with alternating gaps, ROBOT in the middle
+};
+
+/**
+ * One entry of the benchmark corpus. The density is the percentage of
+ * WALL cells and is only used by CORPUS_CLUTTER.
+ */
+struct CorpusCase {
+  const char *name;
+  CorpusKind kind;
+  uint8_t density;
+};
+
+/**
+ * Small xorshift generator so that corpora do not depend on the
+ * platform's rand() implementation.
+ */
+class CorpusRandom {
+
+  public:
+    CorpusRandom(uint32_t seed);
+
+    uint32_t next();
+
+    /**
+     * Returns a value in the range [0, bound).
+     */
+    uint32_t below(uint32_t bound);
+
+  private:
+    uint32_t mState;
+};
+
+/**
+ * The corpus cases exercised by the benchmarks, terminated by an entry
+ * with a NULL name.
+ */
+extern const CorpusCase CORPUS_CASES[];
+
+/**
+ * Fills the map with the requested kind of layout.
+ */
+void generateCorpusMap(Map& map, const CorpusCase& corpusCase, uint32_t seed);
+
+#endif
@@ -0,0 +1,247 @@
+#include <Arduino.h>
+#include <stdlib.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Coordinate.h"
+#include "IWavefront.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "WavefrontCache.h"
+#include "Path.h"
+#include "ObservationQueue.h"
+#include "PyramidPlanner.h"
+#include "WavefrontTrace.h"
+#include "ReservationTable.h"
+#include "SpaceTimeTable.h"
+#include "PlanArena.h"
+#include "TimedPlanner.h"
+#include "CooperativePlanner.h"
+#include "BatchPlanner.h"
+
+/*
+ * The test binary takes over glibc's allocator entry points so that it
+ * can count every call made while a planning call runs. operator new
+ * goes through malloc() too.
+ */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+
+static boolean counting = false;
+static unsigned long allocations = 0;
+
+extern "C" void *malloc(size_t size) {
+  if (counting) {
+    allocations++;
+  }
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+  if (counting) {
+    allocations++;
+  }
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size) {
+  if (counting) {
+    allocations++;
+  }
+  return __libc_realloc(pointer, size);
+}
+
+static void startCounting(void) {
+  allocations = 0;
+  counting = true;
+}
+
+static unsigned long stopCounting(void) {
+  counting = false;
+  return allocations;
+}
+
+/**
+ * Checks that no planning call touches the heap: every engine works in
+ * memory its caller set aside up front.
+ */
+class TestAllocation : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestAllocation);
+  CPPUNIT_TEST(testCounting);
+  CPPUNIT_TEST(testWavefront);
+  CPPUNIT_TEST(testDistanceField);
+  CPPUNIT_TEST(testCache);
+  CPPUNIT_TEST(testPyramid);
+  CPPUNIT_TEST(testPath);
+  CPPUNIT_TEST(testTrace);
+  CPPUNIT_TEST(testTimed);
+  CPPUNIT_TEST(testCooperative);
+  CPPUNIT_TEST(testBatch);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testCounting(void);
+    void testWavefront(void);
+    void testDistanceField(void);
+    void testCache(void);
+    void testPyramid(void);
+    void testPath(void);
+    void testTrace(void);
+    void testTimed(void);
+    void testCooperative(void);
+    void testBatch(void);
+
+  private:
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestAllocation::testCounting(void) {
+  startCounting();
+  void *pointer = malloc(16);
+  char *array = new char[16];
+  unsigned long counted = stopCounting();
+  free(pointer);
+  delete[] array;
+  CPPUNIT_ASSERT(2 == counted);
+}
+
+void TestAllocation::testWavefront(void) {
+  startCounting();
+  uint8_t direction = mMap->propagateWavefront(NULL);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(RIGHT == direction);
+}
+
+void TestAllocation::testDistanceField(void) {
+  Coordinate frontier;
+  mMap->placeValue(0, 9, UNKNOWN);
+
+  startCounting();
+  mField->compute(*mMap, 4, 9, *mQueue);
+  mField->computeUntil(*mMap, 4, 9, *mQueue, 4, 0);
+  mField->nearestFrontier(*mMap, 4, 0, *mQueue, frontier);
+  CPPUNIT_ASSERT(0 == stopCounting());
+}
+
+void TestAllocation::testCache(void) {
+  WavefrontCache *cache = new WavefrontCache();
+
+  startCounting();
+  uint8_t direction = cache->plan(*mMap);
+  cache->plan(*mMap);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(RIGHT == direction);
+  delete cache;
+}
+
+void TestAllocation::testPyramid(void) {
+  PyramidPlanner *planner = new PyramidPlanner();
+  mMap->placeValue(2, 5, WALL);
+
+  startCounting();
+  uint8_t direction = planner->plan(*mMap);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(RIGHT == direction);
+  delete planner;
+}
+
+void TestAllocation::testPath(void) {
+  Path *path = new Path();
+  ObservationQueue *observations = new ObservationQueue();
+  uint16_t repairFrom;
+
+  startCounting();
+  mField->compute(*mMap, 4, 9, *mQueue);
+  boolean extracted = path->extract(*mField, 4, 0);
+  observations->pushCell(4, 5, WALL);
+  uint8_t status = observations->drain(*mMap, *path, repairFrom);
+  boolean repaired = status == PATH_REPAIR &&
+                     path->repair(*mMap, repairFrom, *mField, *mQueue);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(extracted && repaired);
+  delete observations;
+  delete path;
+}
+
+void TestAllocation::testTrace(void) {
+  uint8_t buffer[1024];
+  WavefrontTrace trace(buffer, sizeof(buffer));
+
+  startCounting();
+  mMap->propagateWavefront(&trace);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(! trace.getOverflow());
+}
+
+void TestAllocation::testTimed(void) {
+  static uint8_t scratch[TIMED_PLANNER_ARENA];
+  PlanArena arena(scratch, sizeof(scratch));
+  TimedPlanner planner(arena);
+  ReservationTable reservations;
+  reservations.reserve(4, 5, 3, 6);
+
+  startCounting();
+  mField->compute(*mMap, 4, 9, *mQueue);
+  boolean planned = planner.plan(*mMap, *mField, reservations, 4, 0);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(planned);
+}
+
+void TestAllocation::testCooperative(void) {
+  static uint8_t scratch[COOPERATIVE_ARENA];
+  PlanArena arena(scratch, sizeof(scratch));
+  CooperativePlanner planner(arena);
+  SpaceTimeTable *table = new SpaceTimeTable();
+
+  startCounting();
+  mField->compute(*mMap, 4, 9, *mQueue);
+  boolean first = planner.plan(*mMap, *mField, *table, 0, 4, 0);
+  mField->compute(*mMap, 4, 0, *mQueue);
+  boolean second = planner.plan(*mMap, *mField, *table, 1, 4, 9);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(first && second);
+  delete table;
+}
+
+void TestAllocation::testBatch(void) {
+  BatchPlanner *planner = new BatchPlanner();
+  Map *maps[] = { mMap, mMap, mMap };
+  uint8_t directions[3];
+
+  startCounting();
+  boolean planned = planner->plan(maps, 3, directions);
+  CPPUNIT_ASSERT(0 == stopCounting());
+  CPPUNIT_ASSERT(planned && RIGHT == directions[2]);
+  delete planner;
+}
+
+void TestAllocation::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+}
+
+void TestAllocation::tearDown(void) {
+  counting = false;
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestAllocation );
@@ -0,0 +1,226 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <utility>
+
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "AsyncPlanner.h"
+
+class TestAsyncPlanner : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestAsyncPlanner);
+  CPPUNIT_TEST(testYieldsBetweenSlices);
+  CPPUNIT_TEST(testMatchesDistanceField);
+  CPPUNIT_TEST(testNewerPlanCancels);
+  CPPUNIT_TEST(testCancel);
+  CPPUNIT_TEST(testDroppedPlanFinishes);
+  CPPUNIT_TEST(testReassigned);
+  CPPUNIT_TEST(testAwaited);
+  CPPUNIT_TEST(testNoGoal);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testYieldsBetweenSlices(void);
+    void testMatchesDistanceField(void);
+    void testNewerPlanCancels(void);
+    void testCancel(void);
+    void testDroppedPlanFinishes(void);
+    void testReassigned(void);
+    void testAwaited(void);
+    void testNoGoal(void);
+
+  private:
+    uint8_t expected(void);
+
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+    PlanLoop *mLoop;
+    AsyncPlanner *mPlanner;
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Plans the map the blocking way.
+ */
+uint8_t TestAsyncPlanner::expected(void) {
+  Coordinate robot;
+  Coordinate goal;
+  mMap->locateRobot(robot);
+  mMap->locateGoal(goal);
+  mField->computeUntil(*mMap, goal.getX(), goal.getY(), *mQueue, robot.getX(), robot.getY());
+  return mField->directionFrom(robot.getX(), robot.getY());
+}
+
+/*
+ * Plans the map and hands the result to whoever awaits this.
+ */
+static PlanTask replan(AsyncPlanner& planner, Map& map, uint8_t& seen) {
+  PlanResult result = co_await planner.plan(map);
+  seen = result.direction;
+  co_return result;
+}
+
+void TestAsyncPlanner::testYieldsBetweenSlices(void) {
+  PlanTask task = mPlanner->plan(*mMap);
+  CPPUNIT_ASSERT(! task.isDone());
+  CPPUNIT_ASSERT(1 == mLoop->getPending());
+
+  CPPUNIT_ASSERT(mLoop->runOnce());
+  CPPUNIT_ASSERT(! task.isDone());
+  CPPUNIT_ASSERT(1 == mLoop->getPending());
+
+  uint32_t resumed = 1 + mLoop->run();
+  CPPUNIT_ASSERT(task.isDone());
+  CPPUNIT_ASSERT(0 == mLoop->getPending());
+  CPPUNIT_ASSERT(! mLoop->runOnce());
+
+  PlanResult result = task.getResult();
+  CPPUNIT_ASSERT(! result.cancelled);
+  CPPUNIT_ASSERT(resumed == result.slices);
+  CPPUNIT_ASSERT(result.slices > 4);
+  CPPUNIT_ASSERT(expected() == result.direction);
+}
+
+void TestAsyncPlanner::testMatchesDistanceField(void) {
+  for (uint8_t x=1; x<9; x++) {
+    mMap->placeValue(x, 5, WALL);
+  }
+  PlanTask task = mPlanner->plan(*mMap);
+  mLoop->run();
+
+  CPPUNIT_ASSERT(expected() == task.getResult().direction);
+  DistanceField& field = mPlanner->getField();
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      CPPUNIT_ASSERT(mField->getValue(x, y) == field.getValue(x, y));
+    }
+  }
+}
+
+void TestAsyncPlanner::testNewerPlanCancels(void) {
+  PlanTask stale = mPlanner->plan(*mMap);
+  mLoop->runOnce();
+  CPPUNIT_ASSERT(DOWN == expected());
+
+  // A new frame walls off the way down, leaving only the way left
+  for (uint8_t x=1; x<10; x++) {
+    mMap->placeValue(x, 1, WALL);
+  }
+  PlanTask fresh = mPlanner->plan(*mMap);
+  CPPUNIT_ASSERT(2 == mLoop->getPending());
+
+  // The stale plan gives up at its next turn, without another slice
+  CPPUNIT_ASSERT(mLoop->runOnce());
+  CPPUNIT_ASSERT(stale.isDone());
+  CPPUNIT_ASSERT(stale.getResult().cancelled);
+  CPPUNIT_ASSERT(1 == stale.getResult().slices);
+
+  mLoop->run();
+  CPPUNIT_ASSERT(fresh.isDone());
+  CPPUNIT_ASSERT(! fresh.getResult().cancelled);
+  CPPUNIT_ASSERT(expected() == fresh.getResult().direction);
+  CPPUNIT_ASSERT(LEFT == fresh.getResult().direction);
+}
+
+void TestAsyncPlanner::testCancel(void) {
+  PlanTask task = mPlanner->plan(*mMap);
+  mLoop->runOnce();
+  mPlanner->cancel();
+
+  CPPUNIT_ASSERT(1 == mLoop->run());
+  CPPUNIT_ASSERT(task.getResult().cancelled);
+  CPPUNIT_ASSERT(NOTHING == task.getResult().direction);
+}
+
+void TestAsyncPlanner::testDroppedPlanFinishes(void) {
+  mPlanner->plan(*mMap);
+  CPPUNIT_ASSERT(1 == mLoop->getPending());
+
+  PlanTask task = mPlanner->plan(*mMap);
+  mLoop->run();
+  CPPUNIT_ASSERT(0 == mLoop->getPending());
+  CPPUNIT_ASSERT(expected() == task.getResult().direction);
+}
+
+void TestAsyncPlanner::testReassigned(void) {
+  // Replacing a plan under way leaves it to finish in the loop
+  PlanTask task = mPlanner->plan(*mMap);
+  mLoop->runOnce();
+  task = mPlanner->plan(*mMap);
+  CPPUNIT_ASSERT(2 == mLoop->getPending());
+
+  mLoop->run();
+  CPPUNIT_ASSERT(0 == mLoop->getPending());
+  CPPUNIT_ASSERT(task.isDone());
+  CPPUNIT_ASSERT(! task.getResult().cancelled);
+  CPPUNIT_ASSERT(expected() == task.getResult().direction);
+
+  // The task moved from no longer holds a plan
+  PlanTask moved = std::move(task);
+  CPPUNIT_ASSERT(task.isDone());
+  CPPUNIT_ASSERT(NOTHING == task.getResult().direction);
+  CPPUNIT_ASSERT(! task.getResult().cancelled);
+  CPPUNIT_ASSERT(expected() == moved.getResult().direction);
+  task = std::move(moved);
+  CPPUNIT_ASSERT(moved.isDone());
+  CPPUNIT_ASSERT(NOTHING == moved.getResult().direction);
+
+  // Replacing a finished one frees it straight away
+  task = mPlanner->plan(*mMap);
+  CPPUNIT_ASSERT(1 == mLoop->getPending());
+  mLoop->run();
+  CPPUNIT_ASSERT(task.isDone());
+  CPPUNIT_ASSERT(expected() == task.getResult().direction);
+}
+
+void TestAsyncPlanner::testAwaited(void) {
+  uint8_t seen = NOTHING;
+  PlanTask outer = replan(*mPlanner, *mMap, seen);
+  mLoop->start(outer);
+  CPPUNIT_ASSERT(! outer.isDone());
+
+  mLoop->run();
+  CPPUNIT_ASSERT(outer.isDone());
+  CPPUNIT_ASSERT(! outer.getResult().cancelled);
+  CPPUNIT_ASSERT(expected() == seen);
+  CPPUNIT_ASSERT(seen == outer.getResult().direction);
+}
+
+void TestAsyncPlanner::testNoGoal(void) {
+  mMap->placeValue(9, 0, NOTHING);
+  PlanTask task = mPlanner->plan(*mMap);
+
+  CPPUNIT_ASSERT(1 == mLoop->run());
+  CPPUNIT_ASSERT(! task.getResult().cancelled);
+  CPPUNIT_ASSERT(NOTHING == task.getResult().direction);
+}
+
+void TestAsyncPlanner::setUp(void) {
+  mMap = new Map();
+  mMap->placeValue(0, 9, ROBOT);
+  mMap->placeValue(9, 0, GOAL);
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+  mLoop = new PlanLoop();
+  mPlanner = new AsyncPlanner(*mLoop, 8);
+}
+
+void TestAsyncPlanner::tearDown(void) {
+  delete mPlanner;
+  delete mLoop;
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestAsyncPlanner );
@@ -0,0 +1,154 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "BatchPlanner.h"
+
+/*
+ * Enough maps for two full batches and part of a third.
+ */
+#define TEST_MAPS (BATCH_LANES * 2 + 5)
+
+class TestBatchPlanner : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestBatchPlanner);
+  CPPUNIT_TEST(testSingle);
+  CPPUNIT_TEST(testMatchesField);
+  CPPUNIT_TEST(testBlocked);
+  CPPUNIT_TEST(testMissingRobot);
+  CPPUNIT_TEST(testSizesDiffer);
+  CPPUNIT_TEST(testStopsAtRobots);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testSingle(void);
+    void testMatchesField(void);
+    void testBlocked(void);
+    void testMissingRobot(void);
+    void testSizesDiffer(void);
+    void testStopsAtRobots(void);
+
+  private:
+    Map *mMaps[TEST_MAPS];
+    BatchPlanner *mPlanner;
+    uint8_t mDirections[TEST_MAPS];
+};
+
+//-----------------------------------------------------------------------------
+
+void TestBatchPlanner::testSingle(void) {
+  mMaps[0]->placeValue(4, 0, ROBOT);
+  mMaps[0]->placeValue(4, 9, GOAL);
+  CPPUNIT_ASSERT(mPlanner->plan(mMaps, 1, mDirections));
+  CPPUNIT_ASSERT(RIGHT == mDirections[0]);
+  CPPUNIT_ASSERT(ROBOT == mMaps[0]->getValue(4, 0));
+  CPPUNIT_ASSERT(NOTHING == mMaps[0]->getValue(4, 5));
+
+  // The same answer as the map's own propagation
+  CPPUNIT_ASSERT(mMaps[0]->propagateWavefront(NULL) == mDirections[0]);
+}
+
+void TestBatchPlanner::testMatchesField(void) {
+  CellQueue queue;
+  DistanceField field;
+
+  // Scattered walls, with the robot and goal anywhere else
+  uint32_t seed = 12345;
+  for (uint16_t i=0; i<TEST_MAPS; i++) {
+    for (uint8_t n=0; n<30; n++) {
+      seed = seed * 1103515245 + 12345;
+      mMaps[i]->placeValue((seed >> 16) % 10, (seed >> 8) % 10, WALL);
+    }
+    seed = seed * 1103515245 + 12345;
+    mMaps[i]->placeValue((seed >> 16) % 10, (seed >> 8) % 10, ROBOT);
+    seed = seed * 1103515245 + 12345;
+    mMaps[i]->placeValue((seed >> 16) % 10, (seed >> 8) % 10, GOAL);
+  }
+
+  CPPUNIT_ASSERT(mPlanner->plan(mMaps, TEST_MAPS, mDirections));
+
+  uint16_t planned = 0;
+  for (uint16_t i=0; i<TEST_MAPS; i++) {
+    Coordinate robot;
+    Coordinate goal;
+    uint8_t expected = NOTHING;
+    if (mMaps[i]->locateRobot(robot) && mMaps[i]->locateGoal(goal)) {
+      field.compute(*mMaps[i], goal.getX(), goal.getY(), queue);
+      expected = field.directionFrom(robot.getX(), robot.getY());
+    }
+    CPPUNIT_ASSERT(expected == mDirections[i]);
+    if (expected != NOTHING) {
+      planned++;
+    }
+  }
+  CPPUNIT_ASSERT(planned > TEST_MAPS / 2);
+}
+
+void TestBatchPlanner::testBlocked(void) {
+  for (uint8_t i=0; i<3; i++) {
+    mMaps[i]->placeValue(4, 0, ROBOT);
+    mMaps[i]->placeValue(4, 9, GOAL);
+  }
+  for (uint8_t x=0; x<10; x++) {
+    mMaps[0]->placeValue(x, 5, WALL);
+    mMaps[1]->placeValue(x, 5, UNKNOWN);
+  }
+
+  CPPUNIT_ASSERT(mPlanner->plan(mMaps, 3, mDirections));
+  CPPUNIT_ASSERT(NOTHING == mDirections[0]);
+  CPPUNIT_ASSERT(NOTHING == mDirections[1]);
+  CPPUNIT_ASSERT(RIGHT == mDirections[2]);
+}
+
+void TestBatchPlanner::testMissingRobot(void) {
+  mMaps[0]->placeValue(4, 9, GOAL);
+  mMaps[1]->placeValue(4, 0, ROBOT);
+  CPPUNIT_ASSERT(mPlanner->plan(mMaps, 2, mDirections));
+  CPPUNIT_ASSERT(NOTHING == mDirections[0]);
+  CPPUNIT_ASSERT(NOTHING == mDirections[1]);
+}
+
+void TestBatchPlanner::testSizesDiffer(void) {
+  Map small(5, 5);
+  Map *maps[] = { mMaps[0], &small };
+  CPPUNIT_ASSERT(! mPlanner->plan(maps, 2, mDirections));
+}
+
+void TestBatchPlanner::testStopsAtRobots(void) {
+  for (uint8_t i=0; i<4; i++) {
+    mMaps[i]->placeValue(0, i, ROBOT);
+    mMaps[i]->placeValue(0, 4, GOAL);
+  }
+  CPPUNIT_ASSERT(mPlanner->plan(mMaps, 4, mDirections));
+  for (uint8_t i=0; i<4; i++) {
+    CPPUNIT_ASSERT(RIGHT == mDirections[i]);
+  }
+
+  // The furthest robot is four steps from its goal
+  CPPUNIT_ASSERT(4 == mPlanner->getSweeps());
+}
+
+void TestBatchPlanner::setUp(void) {
+  for (uint16_t i=0; i<TEST_MAPS; i++) {
+    mMaps[i] = new Map();
+  }
+  mPlanner = new BatchPlanner();
+}
+
+void TestBatchPlanner::tearDown(void) {
+  delete mPlanner;
+  for (uint16_t i=0; i<TEST_MAPS; i++) {
+    delete mMaps[i];
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestBatchPlanner );
@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellSet.h"
+
+class TestCellSet : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestCellSet);
+  CPPUNIT_TEST(testAddRemove);
+  CPPUNIT_TEST(testClear);
+  CPPUNIT_TEST(testOffGrid);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testAddRemove(void);
+    void testClear(void);
+    void testOffGrid(void);
+};
+
+//-----------------------------------------------------------------------------
+
+void TestCellSet::testAddRemove(void) {
+  CellSet set;
+  CPPUNIT_ASSERT(! set.contains(3, 4));
+  set.add(3, 4);
+  set.add(3, 5);
+  CPPUNIT_ASSERT(set.contains(3, 4));
+  CPPUNIT_ASSERT(set.contains(3, 5));
+  CPPUNIT_ASSERT(! set.contains(4, 3));
+  set.remove(3, 4);
+  CPPUNIT_ASSERT(! set.contains(3, 4));
+  CPPUNIT_ASSERT(set.contains(3, 5));
+}
+
+void TestCellSet::testClear(void) {
+  CellSet set;
+  set.add(0, 0);
+  set.add(9, 9);
+  set.clear();
+  CPPUNIT_ASSERT(! set.contains(0, 0));
+  CPPUNIT_ASSERT(! set.contains(9, 9));
+}
+
+void TestCellSet::testOffGrid(void) {
+  CellSet set;
+  set.add(100, 100);
+  CPPUNIT_ASSERT(! set.contains(100, 100));
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCellSet );
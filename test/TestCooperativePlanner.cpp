@@ -0,0 +1,216 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "SpaceTimeTable.h"
+#include "PlanArena.h"
+#include "CooperativePlanner.h"
+
+/*
+ * Where each robot of a test fleet is at every step.
+ */
+#define TEST_ROBOTS 3
+#define TEST_STEPS 40
+
+class TestCooperativePlanner : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestCooperativePlanner);
+  CPPUNIT_TEST(testAlone);
+  CPPUNIT_TEST(testCommit);
+  CPPUNIT_TEST(testPassingBay);
+  CPPUNIT_TEST(testCrossing);
+  CPPUNIT_TEST(testGoalParkedOn);
+  CPPUNIT_TEST(testTableFull);
+  CPPUNIT_TEST(testArenaReleased);
+  CPPUNIT_TEST(testArenaTooSmall);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testAlone(void);
+    void testCommit(void);
+    void testPassingBay(void);
+    void testCrossing(void);
+    void testGoalParkedOn(void);
+    void testTableFull(void);
+    void testArenaReleased(void);
+    void testArenaTooSmall(void);
+
+  private:
+    boolean plan(uint8_t robot, uint8_t startX, uint8_t startY, uint8_t goalX, uint8_t goalY);
+    boolean apart(uint8_t robots);
+
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+    SpaceTimeTable *mTable;
+    uint8_t mScratch[COOPERATIVE_ARENA];
+    PlanArena *mArena;
+    CooperativePlanner *mPlanner;
+    uint8_t mX[TEST_ROBOTS][TEST_STEPS];
+    uint8_t mY[TEST_ROBOTS][TEST_STEPS];
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Plans the robot and plays its moves into mX and mY, parking it at the
+ * end.
+ */
+boolean TestCooperativePlanner::plan(uint8_t robot,
+                                     uint8_t startX,
+                                     uint8_t startY,
+                                     uint8_t goalX,
+                                     uint8_t goalY) {
+  mField->compute(*mMap, goalX, goalY, *mQueue);
+  if (! mPlanner->plan(*mMap, *mField, *mTable, robot, startX, startY)) {
+    return false;
+  }
+
+  uint8_t x = startX;
+  uint8_t y = startY;
+  for (uint16_t t=0; t<TEST_STEPS; t++) {
+    mX[robot][t] = x;
+    mY[robot][t] = y;
+    switch (mPlanner->getMove(t)) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+    }
+  }
+  return x == goalX && y == goalY;
+}
+
+/*
+ * Returns true if no two robots ever share a cell or swap cells, and
+ * none of them walks into a wall.
+ */
+boolean TestCooperativePlanner::apart(uint8_t robots) {
+  for (uint8_t a=0; a<robots; a++) {
+    for (uint16_t t=0; t<TEST_STEPS; t++) {
+      if (mMap->getValue(mX[a][t], mY[a][t]) == WALL) {
+        return false;
+      }
+      for (uint8_t b=a+1; b<robots; b++) {
+        if (mX[a][t] == mX[b][t] && mY[a][t] == mY[b][t]) {
+          return false;
+        }
+        if (t > 0 &&
+            mX[a][t] == mX[b][t - 1] && mY[a][t] == mY[b][t - 1] &&
+            mX[b][t] == mX[a][t - 1] && mY[b][t] == mY[a][t - 1]) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void TestCooperativePlanner::testAlone(void) {
+  CPPUNIT_ASSERT(plan(0, 4, 0, 4, 9));
+  CPPUNIT_ASSERT(9 == mPlanner->getLength());
+  for (uint16_t t=0; t<9; t++) {
+    CPPUNIT_ASSERT(RIGHT == mPlanner->getMove(t));
+  }
+  CPPUNIT_ASSERT(NOTHING == mPlanner->getMove(9));
+  CPPUNIT_ASSERT(9 == mPlanner->getExpanded());
+}
+
+void TestCooperativePlanner::testCommit(void) {
+  CPPUNIT_ASSERT(plan(0, 4, 0, 4, 9));
+  for (uint16_t t=0; t<9; t++) {
+    CPPUNIT_ASSERT(0 == mTable->owner(4, t, t));
+    CPPUNIT_ASSERT(NO_ROBOT == mTable->owner(4, t, t + 1));
+  }
+  CPPUNIT_ASSERT(0 == mTable->owner(4, 9, 9));
+  CPPUNIT_ASSERT(0 == mTable->owner(4, 9, 100));
+  CPPUNIT_ASSERT(11 == mTable->getCount());
+}
+
+void TestCooperativePlanner::testPassingBay(void) {
+  // A one-cell corridor along row 4 with a single bay off it at 3, 5
+  for (uint8_t y=0; y<10; y++) {
+    if (y != 5) {
+      mMap->placeValue(3, y, WALL);
+    }
+    mMap->placeValue(5, y, WALL);
+  }
+  mMap->placeValue(2, 5, WALL);
+
+  CPPUNIT_ASSERT(plan(0, 4, 0, 4, 9));
+  CPPUNIT_ASSERT(9 == mPlanner->getLength());
+  CPPUNIT_ASSERT(plan(1, 4, 9, 4, 0));
+  CPPUNIT_ASSERT(apart(2));
+  CPPUNIT_ASSERT(3 == mX[1][5] && 5 == mY[1][5]);
+}
+
+void TestCooperativePlanner::testCrossing(void) {
+  CPPUNIT_ASSERT(plan(0, 4, 0, 4, 9));
+  CPPUNIT_ASSERT(plan(1, 0, 4, 9, 4));
+  CPPUNIT_ASSERT(plan(2, 9, 5, 0, 5));
+  CPPUNIT_ASSERT(apart(3));
+}
+
+void TestCooperativePlanner::testGoalParkedOn(void) {
+  CPPUNIT_ASSERT(plan(0, 4, 0, 4, 9));
+  CPPUNIT_ASSERT(! plan(1, 0, 0, 4, 9));
+  CPPUNIT_ASSERT(! mPlanner->getExhausted());
+}
+
+void TestCooperativePlanner::testTableFull(void) {
+  uint16_t room = SPACE_TIME_SLOTS * 3 / 4;
+  for (uint16_t t=0; t<room-5; t++) {
+    mTable->reserve(9, 9, t + 100, 7);
+  }
+  uint16_t count = mTable->getCount();
+
+  CPPUNIT_ASSERT(! plan(0, 4, 0, 4, 9));
+  CPPUNIT_ASSERT(count == mTable->getCount());
+}
+
+void TestCooperativePlanner::testArenaReleased(void) {
+  CPPUNIT_ASSERT(plan(0, 4, 0, 4, 9));
+  CPPUNIT_ASSERT(plan(1, 4, 9, 4, 0));
+  CPPUNIT_ASSERT(0 == mArena->getUsed());
+  CPPUNIT_ASSERT(mArena->getPeak() > 0);
+  CPPUNIT_ASSERT(mArena->getPeak() <= COOPERATIVE_ARENA);
+  CPPUNIT_ASSERT(apart(2));
+}
+
+void TestCooperativePlanner::testArenaTooSmall(void) {
+  PlanArena arena(mScratch, COOPERATIVE_NODES * sizeof(CooperativeNode));
+  CooperativePlanner planner(arena);
+  mField->compute(*mMap, 4, 9, *mQueue);
+  CPPUNIT_ASSERT(! planner.plan(*mMap, *mField, *mTable, 0, 4, 0));
+  CPPUNIT_ASSERT(planner.getExhausted());
+  CPPUNIT_ASSERT(0 == arena.getUsed());
+  CPPUNIT_ASSERT(0 == mTable->getCount());
+}
+
+void TestCooperativePlanner::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+  mTable = new SpaceTimeTable();
+  mArena = new PlanArena(mScratch, sizeof(mScratch));
+  mPlanner = new CooperativePlanner(*mArena);
+}
+
+void TestCooperativePlanner::tearDown(void) {
+  delete mPlanner;
+  delete mArena;
+  delete mTable;
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestCooperativePlanner );
@@ -123,7 +123,12 @@ class TestMap : public CppUnit::TestFixture {
   CPPUNIT_TEST(testClear);
   CPPUNIT_TEST(testUnPropagate);
   CPPUNIT_TEST(testPropagateWavefront);
+  CPPUNIT_TEST(testPropagateWavefrontNoPath);
   CPPUNIT_TEST(testGridLocationFromCenterRadius);
+  CPPUNIT_TEST(testObstacleHash);
+  CPPUNIT_TEST(testLocateRobotAndGoal);
+  CPPUNIT_TEST(testForget);
+  CPPUNIT_TEST(testPropagateAroundUnknown);
   CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -140,7 +145,12 @@ class TestMap : public CppUnit::TestFixture {
     void testClear(void);
     void testUnPropagate(void);
     void testPropagateWavefront(void);
+    void testPropagateWavefrontNoPath(void);
     void testGridLocationFromCenterRadius(void);
+    void testObstacleHash(void);
+    void testLocateRobotAndGoal(void);
+    void testForget(void);
+    void testPropagateAroundUnknown(void);
 
   private:
     Map *mMap;
@@ -437,6 +447,20 @@ void TestMap::testPropagateWavefront(void) {
   CPPUNIT_ASSERT(15 == mMap->getValue(9, 0));
 }
 
+void TestMap::testPropagateWavefrontNoPath(void) {
+  /*
+   * Goal completely walled off from the robot.
+   */
+  mMap->placeValue(0, 0, ROBOT);
+  mMap->placeValue(9, 9, GOAL);
+  mMap->placeValue(8, 9, WALL);
+  mMap->placeValue(9, 8, WALL);
+
+  CPPUNIT_ASSERT(NOTHING == mMap->propagateWavefront(NULL));
+  CPPUNIT_ASSERT(ROBOT == mMap->getValue(0, 0));
+  CPPUNIT_ASSERT(GOAL == mMap->getValue(9, 9));
+}
+
 void TestMap::testGridLocationFromCenterRadius(void) {
   Coordinate coord;
   for (int angle=0; angle<360; angle += 30) {
@@ -494,6 +518,97 @@ void TestMap::testGridLocationFromCenterRadius(void) {
   }
 }
 
+void TestMap::testObstacleHash(void) {
+  uint32_t empty = mMap->getObstacleHash();
+
+  // Only walls contribute
+  mMap->placeValue(1, 1, ROBOT);
+  mMap->placeValue(2, 2, 17);
+  CPPUNIT_ASSERT(empty == mMap->getObstacleHash());
+
+  mMap->placeValue(3, 3, WALL);
+  uint32_t oneWall = mMap->getObstacleHash();
+  CPPUNIT_ASSERT(empty != oneWall);
+
+  // Placing the same wall again changes nothing
+  mMap->placeValue(3, 3, WALL);
+  CPPUNIT_ASSERT(oneWall == mMap->getObstacleHash());
+
+  mMap->placeValue(3, 4, WALL);
+  CPPUNIT_ASSERT(oneWall != mMap->getObstacleHash());
+  mMap->placeValue(3, 4, NOTHING);
+  CPPUNIT_ASSERT(oneWall == mMap->getObstacleHash());
+
+  // Propagation keeps the walls
+  mMap->propagateWavefront(NULL);
+  CPPUNIT_ASSERT(oneWall == mMap->getObstacleHash());
+
+  mMap->clear();
+  CPPUNIT_ASSERT(empty == mMap->getObstacleHash());
+}
+
+void TestMap::testLocateRobotAndGoal(void) {
+  Coordinate coord;
+  CPPUNIT_ASSERT(! mMap->locateRobot(coord));
+  CPPUNIT_ASSERT(! mMap->locateGoal(coord));
+
+  mMap->placeValue(2, 3, ROBOT);
+  mMap->placeValue(7, 8, GOAL);
+  CPPUNIT_ASSERT(mMap->locateRobot(coord));
+  CPPUNIT_ASSERT(2 == coord.getX());
+  CPPUNIT_ASSERT(3 == coord.getY());
+  CPPUNIT_ASSERT(mMap->locateGoal(coord));
+  CPPUNIT_ASSERT(7 == coord.getX());
+  CPPUNIT_ASSERT(8 == coord.getY());
+
+  // Overwriting the last placed goal falls back to any other goal
+  mMap->placeValue(1, 1, GOAL);
+  mMap->placeValue(1, 1, WALL);
+  CPPUNIT_ASSERT(mMap->locateGoal(coord));
+  CPPUNIT_ASSERT(7 == coord.getX());
+  CPPUNIT_ASSERT(8 == coord.getY());
+}
+
+void TestMap::testForget(void) {
+  uint32_t empty = mMap->getObstacleHash();
+
+  mMap->placeValue(1, 2, ROBOT);
+  mMap->placeValue(1, 3, GOAL);
+  mMap->placeValue(1, 4, 23);
+  mMap->placeValue(1, 5, WALL);
+
+  mMap->forget();
+
+  CPPUNIT_ASSERT(ROBOT == mMap->getValue(1, 2));
+  CPPUNIT_ASSERT(GOAL == mMap->getValue(1, 3));
+  CPPUNIT_ASSERT(UNKNOWN == mMap->getValue(1, 4));
+  CPPUNIT_ASSERT(UNKNOWN == mMap->getValue(1, 5));
+  CPPUNIT_ASSERT(UNKNOWN == mMap->getValue(9, 9));
+
+  // Unknown cells block the wave, so they count towards the hash
+  uint32_t forgotten = mMap->getObstacleHash();
+  CPPUNIT_ASSERT(empty != forgotten);
+  mMap->placeValue(9, 9, WALL);
+  CPPUNIT_ASSERT(forgotten == mMap->getObstacleHash());
+  mMap->placeValue(9, 9, NOTHING);
+  CPPUNIT_ASSERT(forgotten != mMap->getObstacleHash());
+
+  mMap->unpropagate();
+  CPPUNIT_ASSERT(UNKNOWN == mMap->getValue(1, 4));
+}
+
+void TestMap::testPropagateAroundUnknown(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  mMap->placeValue(3, 4, UNKNOWN);
+  mMap->placeValue(4, 4, UNKNOWN);
+  mMap->placeValue(5, 4, UNKNOWN);
+
+  CPPUNIT_ASSERT(DOWN == mMap->propagateWavefront(NULL));
+  CPPUNIT_ASSERT(UNKNOWN == mMap->getValue(4, 4));
+  CPPUNIT_ASSERT(5 == mMap->getValue(4, 5));
+}
+
 void TestMap::setUp(void) {
   mMap = new Map();
 }
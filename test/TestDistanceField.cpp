@@ -0,0 +1,248 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Coordinate.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+
+class TestDistanceField : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestDistanceField);
+  CPPUNIT_TEST(testEmptyField);
+  CPPUNIT_TEST(testCompute);
+  CPPUNIT_TEST(testDirectionFrom);
+  CPPUNIT_TEST(testUnreachable);
+  CPPUNIT_TEST(testNoDirectionFromBlocked);
+  CPPUNIT_TEST(testGoalOnWall);
+  CPPUNIT_TEST(testComputeUntil);
+  CPPUNIT_TEST(testResume);
+  CPPUNIT_TEST(testUnknownBlocks);
+  CPPUNIT_TEST(testNearestFrontier);
+  CPPUNIT_TEST(testRobotOnFrontier);
+  CPPUNIT_TEST(testNoFrontier);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testEmptyField(void);
+    void testCompute(void);
+    void testDirectionFrom(void);
+    void testUnreachable(void);
+    void testNoDirectionFromBlocked(void);
+    void testGoalOnWall(void);
+    void testComputeUntil(void);
+    void testResume(void);
+    void testUnknownBlocks(void);
+    void testNearestFrontier(void);
+    void testRobotOnFrontier(void);
+    void testNoFrontier(void);
+
+  private:
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestDistanceField::testEmptyField(void) {
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(0, 0));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(0, 0));
+}
+
+void TestDistanceField::testCompute(void) {
+  // Same layout as TestMap::testPropagateWavefront
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  mMap->placeValue(3, 4, WALL);
+  mMap->placeValue(4, 4, WALL);
+  mMap->placeValue(5, 4, WALL);
+
+  mField->compute(*mMap, 4, 9, *mQueue);
+
+  CPPUNIT_ASSERT(10 == mField->getSizeX());
+  CPPUNIT_ASSERT(4 == mField->getGoalX());
+  CPPUNIT_ASSERT(9 == mField->getGoalY());
+  CPPUNIT_ASSERT(GOAL == mField->getValue(4, 9));
+  CPPUNIT_ASSERT(2 == mField->getValue(3, 9));
+  CPPUNIT_ASSERT(6 == mField->getValue(9, 9));
+  CPPUNIT_ASSERT(WALL == mField->getValue(4, 4));
+  CPPUNIT_ASSERT(8 == mField->getValue(2, 4));
+  CPPUNIT_ASSERT(13 == mField->getValue(3, 0));
+  CPPUNIT_ASSERT(14 == mField->getValue(4, 0)); // the robot's cell
+  CPPUNIT_ASSERT(14 == mField->getValue(0, 0));
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(100, 100));
+
+  // The map itself is left alone
+  CPPUNIT_ASSERT(ROBOT == mMap->getValue(4, 0));
+  CPPUNIT_ASSERT(NOTHING == mMap->getValue(3, 9));
+}
+
+void TestDistanceField::testDirectionFrom(void) {
+  mMap->placeValue(3, 4, WALL);
+  mMap->placeValue(4, 4, WALL);
+  mMap->placeValue(5, 4, WALL);
+
+  mField->compute(*mMap, 4, 9, *mQueue);
+
+  // Same tie-break as Map::propagateWavefront
+  CPPUNIT_ASSERT(DOWN == mField->directionFrom(4, 0));
+  CPPUNIT_ASSERT(RIGHT == mField->directionFrom(4, 5));
+  CPPUNIT_ASSERT(UP == mField->directionFrom(9, 9));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(4, 9));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(100, 100));
+}
+
+void TestDistanceField::testUnreachable(void) {
+  mMap->placeValue(8, 9, WALL);
+  mMap->placeValue(9, 8, WALL);
+
+  mField->compute(*mMap, 9, 9, *mQueue);
+
+  CPPUNIT_ASSERT(GOAL == mField->getValue(9, 9));
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(0, 0));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(0, 0));
+}
+
+void TestDistanceField::testNoDirectionFromBlocked(void) {
+  mMap->placeValue(4, 5, WALL);
+  mMap->placeValue(5, 4, UNKNOWN);
+  mField->computeUntil(*mMap, 5, 5, *mQueue, 5, 7);
+
+  // Each of these is next to a cell the wave reached
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(4, 5));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(5, 4));
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(5, 8));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(5, 8));
+  CPPUNIT_ASSERT(LEFT == mField->directionFrom(5, 7));
+}
+
+void TestDistanceField::testGoalOnWall(void) {
+  mMap->placeValue(5, 5, WALL);
+
+  mField->compute(*mMap, 5, 5, *mQueue);
+
+  CPPUNIT_ASSERT(WALL == mField->getValue(5, 5));
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(5, 6));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(5, 6));
+}
+
+void TestDistanceField::testComputeUntil(void) {
+  CPPUNIT_ASSERT(mField->computeUntil(*mMap, 0, 0, *mQueue, 2, 0));
+  CPPUNIT_ASSERT(3 == mField->getValue(2, 0));
+  CPPUNIT_ASSERT(UP == mField->directionFrom(2, 0));
+
+  // The far corner was never reached
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(9, 9));
+
+  mMap->placeValue(8, 9, WALL);
+  mMap->placeValue(9, 8, WALL);
+  CPPUNIT_ASSERT(! mField->computeUntil(*mMap, 0, 0, *mQueue, 9, 9));
+}
+
+void TestDistanceField::testResume(void) {
+  DistanceField whole;
+  whole.computeUntil(*mMap, 0, 0, *mQueue, 6, 7);
+
+  mField->begin(*mMap, 0, 0, *mQueue, 6, 7);
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(1, 0));
+  uint8_t slices = 1;
+  while (! mField->resume(*mQueue, 5)) {
+    slices++;
+  }
+  CPPUNIT_ASSERT(slices > 5);
+  CPPUNIT_ASSERT(mField->resume(*mQueue, 5));
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      CPPUNIT_ASSERT(whole.getValue(x, y) == mField->getValue(x, y));
+    }
+  }
+
+  // Walled off: done once there is nothing left to reach
+  mMap->placeValue(8, 9, WALL);
+  mMap->placeValue(9, 8, WALL);
+  mField->begin(*mMap, 0, 0, *mQueue, 9, 9);
+  while (! mField->resume(*mQueue, 5)) {
+  }
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(9, 9));
+  CPPUNIT_ASSERT(17 == mField->getValue(9, 7));
+}
+
+void TestDistanceField::testUnknownBlocks(void) {
+  for (uint8_t x=0; x<10; x++) {
+    mMap->placeValue(x, 5, UNKNOWN);
+  }
+
+  mField->compute(*mMap, 0, 0, *mQueue);
+
+  CPPUNIT_ASSERT(UNKNOWN == mField->getValue(3, 5));
+  CPPUNIT_ASSERT(5 == mField->getValue(0, 4));
+  CPPUNIT_ASSERT(NOTHING == mField->getValue(0, 6));
+}
+
+void TestDistanceField::testNearestFrontier(void) {
+  // Explored the left half of the map; a wall hides the nearest
+  // unknown cell straight ahead
+  mMap->forget();
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<5; y++) {
+      mMap->placeValue(x, y, NOTHING);
+    }
+  }
+  mMap->placeValue(5, 4, WALL);
+  mMap->placeValue(5, 3, ROBOT);
+
+  Coordinate frontier;
+  uint8_t direction = mField->nearestFrontier(*mMap, 5, 3, *mQueue, frontier);
+
+  // 4, 4 and 6, 4 are both two steps away; the wave reaches DOWN first
+  CPPUNIT_ASSERT(DOWN == direction);
+  CPPUNIT_ASSERT(6 == frontier.getX());
+  CPPUNIT_ASSERT(4 == frontier.getY());
+  CPPUNIT_ASSERT(UNKNOWN == mMap->getValue(6, 5));
+}
+
+void TestDistanceField::testRobotOnFrontier(void) {
+  mMap->placeValue(3, 4, UNKNOWN);
+
+  Coordinate frontier;
+  CPPUNIT_ASSERT(NOTHING == mField->nearestFrontier(*mMap, 3, 3, *mQueue, frontier));
+  CPPUNIT_ASSERT(3 == frontier.getX());
+  CPPUNIT_ASSERT(3 == frontier.getY());
+}
+
+void TestDistanceField::testNoFrontier(void) {
+  Coordinate frontier;
+
+  // Everything known
+  CPPUNIT_ASSERT(NOTHING == mField->nearestFrontier(*mMap, 3, 3, *mQueue, frontier));
+  CPPUNIT_ASSERT(0xff == frontier.getX());
+  CPPUNIT_ASSERT(0xff == frontier.getY());
+
+  // Unknown cells only behind a wall
+  mMap->placeValue(0, 1, WALL);
+  mMap->placeValue(1, 0, WALL);
+  mMap->placeValue(0, 0, UNKNOWN);
+  CPPUNIT_ASSERT(NOTHING == mField->nearestFrontier(*mMap, 3, 3, *mQueue, frontier));
+  CPPUNIT_ASSERT(0xff == frontier.getX());
+}
+
+void TestDistanceField::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+}
+
+void TestDistanceField::tearDown(void) {
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestDistanceField );
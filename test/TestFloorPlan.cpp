@@ -0,0 +1,188 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "FloorPlan.h"
+
+/*
+ * tools/floorplangen output for
+ *
+ *   #..
+ *   .#.
+ *   ...
+ */
+static const uint8_t SMALL_PLAN[] PROGMEM = {
+  0x03, 0x03, 0x11, 0x00, 0x20, 0x4c, 0x50, 0xa3, 0x09
+};
+static_assert(sizeof(SMALL_PLAN) == FLOOR_PLAN_BYTES(3, 3), "SMALL_PLAN does not match its size");
+
+class TestFloorPlan : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestFloorPlan);
+  CPPUNIT_TEST(testBytes);
+  CPPUNIT_TEST(testProgmem);
+  CPPUNIT_TEST(testBuild);
+  CPPUNIT_TEST(testTooSmall);
+  CPPUNIT_TEST(testApply);
+  CPPUNIT_TEST(testComputeMatchesMap);
+  CPPUNIT_TEST(testOverlay);
+  CPPUNIT_TEST(testComputeWinding);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testBytes(void);
+    void testProgmem(void);
+    void testBuild(void);
+    void testTooSmall(void);
+    void testApply(void);
+    void testComputeMatchesMap(void);
+    void testOverlay(void);
+    void testComputeWinding(void);
+
+  private:
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+    uint8_t mTable[FLOOR_PLAN_BYTES(DEFAULT_X_SIZE, DEFAULT_Y_SIZE)];
+};
+
+//-----------------------------------------------------------------------------
+
+void TestFloorPlan::testBytes(void) {
+  CPPUNIT_ASSERT(65 == FLOOR_PLAN_BYTES(10, 10));
+  CPPUNIT_ASSERT(9 == sizeof(SMALL_PLAN));
+}
+
+void TestFloorPlan::testProgmem(void) {
+  FloorPlan plan(SMALL_PLAN, true);
+  CPPUNIT_ASSERT(3 == plan.getSizeX());
+  CPPUNIT_ASSERT(3 == plan.getSizeY());
+  CPPUNIT_ASSERT(plan.isWall(0, 0));
+  CPPUNIT_ASSERT(plan.isWall(1, 1));
+  CPPUNIT_ASSERT(! plan.isWall(2, 2));
+  CPPUNIT_ASSERT(plan.isWall(3, 0));
+
+  CPPUNIT_ASSERT(0 == plan.getNeighbours(0, 0));
+  CPPUNIT_ASSERT(1 << (RIGHT - 1) == plan.getNeighbours(0, 1));
+  CPPUNIT_ASSERT(((1 << (UP - 1)) | (1 << (DOWN - 1))) == plan.getNeighbours(1, 2));
+  CPPUNIT_ASSERT(((1 << (UP - 1)) | (1 << (LEFT - 1))) == plan.getNeighbours(2, 2));
+  CPPUNIT_ASSERT(0 == plan.getNeighbours(0, 3));
+}
+
+void TestFloorPlan::testBuild(void) {
+  Map map(3, 3);
+  map.placeValue(0, 0, WALL);
+  map.placeValue(1, 1, WALL);
+  map.placeValue(2, 0, ROBOT);
+  CPPUNIT_ASSERT(FloorPlan::build(map, mTable, sizeof(mTable)));
+  CPPUNIT_ASSERT(0 == memcmp(SMALL_PLAN, mTable, sizeof(SMALL_PLAN)));
+}
+
+void TestFloorPlan::testTooSmall(void) {
+  CPPUNIT_ASSERT(! FloorPlan::build(*mMap, mTable, FLOOR_PLAN_BYTES(10, 10) - 1));
+}
+
+void TestFloorPlan::testApply(void) {
+  CPPUNIT_ASSERT(FloorPlan::build(*mMap, mTable, sizeof(mTable)));
+  Map map;
+  map.placeValue(4, 0, ROBOT);
+  uint32_t hash = mMap->getObstacleHash();
+
+  FloorPlan plan(mTable, false);
+  plan.apply(map);
+  CPPUNIT_ASSERT(hash == map.getObstacleHash());
+  CPPUNIT_ASSERT(WALL == map.getValue(3, 5));
+  CPPUNIT_ASSERT(ROBOT == map.getValue(4, 0));
+}
+
+void TestFloorPlan::testComputeMatchesMap(void) {
+  CPPUNIT_ASSERT(FloorPlan::build(*mMap, mTable, sizeof(mTable)));
+  FloorPlan plan(mTable, false);
+  CellSet overlay;
+  DistanceField field;
+
+  mField->compute(*mMap, 4, 9, *mQueue);
+  field.compute(plan, overlay, 4, 9);
+  CPPUNIT_ASSERT(10 == field.getSizeX() && 10 == field.getSizeY());
+  CPPUNIT_ASSERT(4 == field.getGoalX() && 9 == field.getGoalY());
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      CPPUNIT_ASSERT(mField->getValue(x, y) == field.getValue(x, y));
+    }
+  }
+}
+
+void TestFloorPlan::testOverlay(void) {
+  CPPUNIT_ASSERT(FloorPlan::build(*mMap, mTable, sizeof(mTable)));
+  FloorPlan plan(mTable, false);
+  CellSet overlay;
+  DistanceField field;
+
+  // An obstacle seen at run time, and the same one on the map
+  overlay.add(4, 8);
+  mMap->placeValue(4, 8, WALL);
+
+  mField->compute(*mMap, 4, 9, *mQueue);
+  field.compute(plan, overlay, 4, 9);
+  CPPUNIT_ASSERT(WALL == field.getValue(4, 8));
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      CPPUNIT_ASSERT(mField->getValue(x, y) == field.getValue(x, y));
+    }
+  }
+}
+
+void TestFloorPlan::testComputeWinding(void) {
+  // A corridor that doubles back on itself, so cells far apart on the
+  // grid are labelled in the same sweep and neighbours many sweeps apart
+  Map map;
+  for (uint8_t x=1; x<10; x+=2) {
+    for (uint8_t y=0; y<10; y++) {
+      if (y != ((x & 2) ? 0 : 9)) {
+        map.placeValue(x, y, WALL);
+      }
+    }
+  }
+  CPPUNIT_ASSERT(FloorPlan::build(map, mTable, sizeof(mTable)));
+  FloorPlan plan(mTable, false);
+  CellSet overlay;
+  DistanceField field;
+
+  mField->compute(map, 0, 0, *mQueue);
+  field.compute(plan, overlay, 0, 0);
+  CPPUNIT_ASSERT(GOAL + 5 * 10 + 4 - 1 == field.getValue(8, 9));
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      CPPUNIT_ASSERT(mField->getValue(x, y) == field.getValue(x, y));
+    }
+  }
+}
+
+void TestFloorPlan::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+
+  // A wall across the middle with a gap at the bottom
+  for (uint8_t x=0; x<9; x++) {
+    mMap->placeValue(x, 5, WALL);
+  }
+  mMap->placeValue(2, 2, WALL);
+}
+
+void TestFloorPlan::tearDown(void) {
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestFloorPlan );
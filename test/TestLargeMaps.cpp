@@ -0,0 +1,182 @@
+#include <Arduino.h>
+#include <iostream>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestResultCollector.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/BriefTestProgressListener.h>
+#include <cppunit/CompilerOutputter.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "NextHopTable.h"
+#include "BatchPlanner.h"
+
+/**
+ * Tests of behaviour that only shows on maps too big for the 10x10
+ * storage the main suite is built with. This is the main() of its own
+ * binary, built against storage of LARGESIZE along with the tests of the
+ * host tools (see the Makefile).
+ */
+class TestLargeMaps : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestLargeMaps);
+  CPPUNIT_TEST(testNextHopShortCorridor);
+  CPPUNIT_TEST(testNextHopLongCorridor);
+  CPPUNIT_TEST(testNextHopOpenMap);
+  CPPUNIT_TEST(testBatchPastWaveLimit);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testNextHopShortCorridor(void);
+    void testNextHopLongCorridor(void);
+    void testNextHopOpenMap(void);
+    void testBatchPastWaveLimit(void);
+
+  private:
+    void serpentine(Map& map);
+    boolean build(Map& map);
+
+    CellQueue *mQueue;
+    DistanceField *mField;
+    uint8_t *mTable;
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Walls off every other row but for a gap at alternate ends, leaving a
+ * single corridor that winds from 0, 0 to the last row.
+ */
+void TestLargeMaps::serpentine(Map& map) {
+  for (uint8_t x=1; x<map.getSizeX(); x+=2) {
+    uint8_t gap = (x & 2) ? 0 : map.getSizeY() - 1;
+    for (uint8_t y=0; y<map.getSizeY(); y++) {
+      if (y != gap) {
+        map.placeValue(x, y, WALL);
+      }
+    }
+  }
+}
+
+boolean TestLargeMaps::build(Map& map) {
+  return NextHopTable::build(map, mTable,
+                             NEXT_HOP_TABLE_BYTES(map.getSizeX(), map.getSizeY()),
+                             *mField, *mQueue);
+}
+
+void TestLargeMaps::testNextHopShortCorridor(void) {
+  // 5 runs of 25 cells and the 4 gaps between them
+  Map map(9, 25);
+  serpentine(map);
+  CPPUNIT_ASSERT(build(map));
+  NextHopTable table(mTable, false);
+
+  uint8_t x = 8;
+  uint8_t y = 24;
+  uint16_t steps = 0;
+  uint8_t direction;
+  while ((direction = table.nextHop(0, 0, x, y)) != NOTHING) {
+    switch (direction) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+    }
+    CPPUNIT_ASSERT(WALL != map.getValue(x, y));
+    steps++;
+  }
+  CPPUNIT_ASSERT(0 == x && 0 == y);
+  CPPUNIT_ASSERT(5 * 25 + 4 - 1 == steps);
+}
+
+void TestLargeMaps::testNextHopLongCorridor(void) {
+  // Far longer than a field can reach, so no table can be built
+  Map map(39, 39);
+  serpentine(map);
+  CPPUNIT_ASSERT(! build(map));
+}
+
+void TestLargeMaps::testNextHopOpenMap(void) {
+  // Two areas, each well within a field's reach
+  Map map(40, 40);
+  for (uint8_t y=0; y<40; y++) {
+    map.placeValue(20, y, WALL);
+  }
+  CPPUNIT_ASSERT(build(map));
+  NextHopTable table(mTable, false);
+
+  for (uint8_t goal=0; goal<40; goal+=13) {
+    mField->compute(map, goal, 39 - goal, *mQueue);
+    for (uint8_t x=0; x<40; x++) {
+      for (uint8_t y=0; y<40; y++) {
+        CPPUNIT_ASSERT(mField->directionFrom(x, y) == table.nextHop(goal, 39 - goal, x, y));
+      }
+    }
+  }
+}
+
+void TestLargeMaps::testBatchPastWaveLimit(void) {
+  // Along the corridor from the goal at 0, 0, row 14 runs left from 231
+  // steps at its right end, so 14, 14 is the last cell the wave labels
+  // and 14, 13 the first it never reaches
+  Map reached(32, 32);
+  Map beyond(32, 32);
+  serpentine(reached);
+  serpentine(beyond);
+  reached.placeValue(0, 0, GOAL);
+  beyond.placeValue(0, 0, GOAL);
+  reached.placeValue(14, 14, ROBOT);
+  beyond.placeValue(14, 13, ROBOT);
+
+  BatchPlanner *planner = new BatchPlanner();
+  Map *maps[] = { &reached, &beyond };
+  uint8_t directions[2];
+  CPPUNIT_ASSERT(planner->plan(maps, 2, directions));
+  delete planner;
+
+  mField->compute(reached, 0, 0, *mQueue);
+  CPPUNIT_ASSERT(RIGHT == mField->directionFrom(14, 14));
+  CPPUNIT_ASSERT(NOTHING == mField->directionFrom(14, 13));
+  CPPUNIT_ASSERT(RIGHT == directions[0]);
+  CPPUNIT_ASSERT(NOTHING == directions[1]);
+}
+
+void TestLargeMaps::setUp(void) {
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+  mTable = new uint8_t[NEXT_HOP_TABLE_BYTES(40, 40)];
+}
+
+void TestLargeMaps::tearDown(void) {
+  delete [] mTable;
+  delete mField;
+  delete mQueue;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestLargeMaps );
+
+int main(int argc, char* argv[]) {
+  CPPUNIT_NS::TestResult testresult;
+  CPPUNIT_NS::TestResultCollector collectedresults;
+  testresult.addListener(&collectedresults);
+  CPPUNIT_NS::BriefTestProgressListener progress;
+  testresult.addListener(&progress);
+
+  CPPUNIT_NS::TestRunner testrunner;
+  testrunner.addTest(CPPUNIT_NS::TestFactoryRegistry::getRegistry().makeTest());
+  testrunner.run(testresult);
+
+  CPPUNIT_NS::CompilerOutputter compileroutputter(&collectedresults, std::cerr);
+  compileroutputter.write();
+
+  return collectedresults.wasSuccessful() ? 0 : 1;
+}
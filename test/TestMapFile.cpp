@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <string>
+
+#include "Map.h"
+#include "MapFile.h"
+
+class TestMapFile : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestMapFile);
+  CPPUNIT_TEST(testParse);
+  CPPUNIT_TEST(testFill);
+  CPPUNIT_TEST(testCommentsAndLineEnds);
+  CPPUNIT_TEST(testEmpty);
+  CPPUNIT_TEST(testUnexpectedCharacter);
+  CPPUNIT_TEST(testTooLarge);
+  CPPUNIT_TEST(testLoad);
+  CPPUNIT_TEST(testLoadMissing);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testParse(void);
+    void testFill(void);
+    void testCommentsAndLineEnds(void);
+    void testEmpty(void);
+    void testUnexpectedCharacter(void);
+    void testTooLarge(void);
+    void testLoad(void);
+    void testLoadMissing(void);
+};
+
+//-----------------------------------------------------------------------------
+
+void TestMapFile::testParse(void) {
+  MapFile file;
+  CPPUNIT_ASSERT(file.parse("R..#\n.#?\n...G\n"));
+  CPPUNIT_ASSERT(3 == file.getSizeX());
+  CPPUNIT_ASSERT(4 == file.getSizeY());
+  CPPUNIT_ASSERT(file.getError().empty());
+}
+
+void TestMapFile::testFill(void) {
+  MapFile file;
+  CPPUNIT_ASSERT(file.parse("R. #\n.#?\n...G\n"));
+  Map map(file.getSizeX(), file.getSizeY());
+  map.placeValue(1, 3, WALL);
+  file.fill(map);
+
+  CPPUNIT_ASSERT(ROBOT == map.getValue(0, 0));
+  CPPUNIT_ASSERT(NOTHING == map.getValue(0, 2));
+  CPPUNIT_ASSERT(WALL == map.getValue(0, 3));
+  CPPUNIT_ASSERT(WALL == map.getValue(1, 1));
+  CPPUNIT_ASSERT(UNKNOWN == map.getValue(1, 2));
+  CPPUNIT_ASSERT(GOAL == map.getValue(2, 3));
+
+  // Short lines are padded, over whatever the map held before
+  CPPUNIT_ASSERT(NOTHING == map.getValue(1, 3));
+}
+
+void TestMapFile::testCommentsAndLineEnds(void) {
+  MapFile file;
+  CPPUNIT_ASSERT(file.parse("; a comment\r\nR.\r\n; another\r\n.G\r\n\r\n\n"));
+  CPPUNIT_ASSERT(2 == file.getSizeX());
+  CPPUNIT_ASSERT(2 == file.getSizeY());
+
+  Map map(2, 2);
+  file.fill(map);
+  CPPUNIT_ASSERT(GOAL == map.getValue(1, 1));
+}
+
+void TestMapFile::testEmpty(void) {
+  MapFile file;
+  CPPUNIT_ASSERT(! file.parse(""));
+  CPPUNIT_ASSERT("empty map" == file.getError());
+  CPPUNIT_ASSERT(! file.parse("; only a comment\n\n\n"));
+  CPPUNIT_ASSERT("empty map" == file.getError());
+}
+
+void TestMapFile::testUnexpectedCharacter(void) {
+  MapFile file;
+  CPPUNIT_ASSERT(! file.parse("R..\n..X\n"));
+  CPPUNIT_ASSERT("unexpected 'X' at 1,2" == file.getError());
+
+  // A good parse clears the error
+  CPPUNIT_ASSERT(file.parse("R.G\n"));
+  CPPUNIT_ASSERT(file.getError().empty());
+}
+
+void TestMapFile::testTooLarge(void) {
+  MapFile file;
+  std::string wide(DEFAULT_Y_SIZE + 1, '.');
+  CPPUNIT_ASSERT(! file.parse(wide + "\n"));
+  CPPUNIT_ASSERT("map larger than DEFAULT_X_SIZE x DEFAULT_Y_SIZE" == file.getError());
+
+  std::string tall;
+  for (unsigned x=0; x<DEFAULT_X_SIZE + 1u; x++) {
+    tall += ".\n";
+  }
+  CPPUNIT_ASSERT(! file.parse(tall));
+
+  std::string largest(DEFAULT_Y_SIZE, '.');
+  CPPUNIT_ASSERT(file.parse(largest + "\n"));
+}
+
+void TestMapFile::testLoad(void) {
+  char path[] = "/tmp/testmapfileXXXXXX";
+  int fd = mkstemp(path);
+  CPPUNIT_ASSERT(fd >= 0);
+  FILE *out = fdopen(fd, "w");
+  fputs("R#\n.G\n", out);
+  fclose(out);
+
+  MapFile file;
+  CPPUNIT_ASSERT(file.load(path));
+  CPPUNIT_ASSERT(2 == file.getSizeX());
+  CPPUNIT_ASSERT(2 == file.getSizeY());
+  remove(path);
+}
+
+void TestMapFile::testLoadMissing(void) {
+  MapFile file;
+  CPPUNIT_ASSERT(! file.load("/nonexistent/missing.map"));
+  CPPUNIT_ASSERT("cannot open /nonexistent/missing.map" == file.getError());
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestMapFile );
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <set>
+
+#include "Map.h"
+
+class TestMapLayout : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestMapLayout);
+  CPPUNIT_TEST(testIndexIsUnique);
+  CPPUNIT_TEST(testSteps);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testIndexIsUnique(void);
+    void testSteps(void);
+};
+
+//-----------------------------------------------------------------------------
+
+void TestMapLayout::testIndexIsUnique(void) {
+  std::set<uint16_t> seen;
+  for (uint8_t x=0; x<DEFAULT_X_SIZE; x++) {
+    for (uint8_t y=0; y<DEFAULT_Y_SIZE; y++) {
+      uint16_t index = layoutIndex(x, y);
+      CPPUNIT_ASSERT(index < MAP_LAYOUT_CELLS);
+      CPPUNIT_ASSERT(seen.insert(index).second);
+    }
+  }
+}
+
+void TestMapLayout::testSteps(void) {
+  for (uint8_t x=0; x<DEFAULT_X_SIZE; x++) {
+    for (uint8_t y=0; y<DEFAULT_Y_SIZE; y++) {
+      uint16_t index = layoutIndex(x, y);
+      if (x + 1 < DEFAULT_X_SIZE) {
+        CPPUNIT_ASSERT(layoutIndex(x + 1, y) == layoutStepDown(index, x));
+      }
+      if (x > 0) {
+        CPPUNIT_ASSERT(layoutIndex(x - 1, y) == layoutStepUp(index, x));
+      }
+      if (y + 1 < DEFAULT_Y_SIZE) {
+        CPPUNIT_ASSERT(layoutIndex(x, y + 1) == layoutStepRight(index, y));
+      }
+      if (y > 0) {
+        CPPUNIT_ASSERT(layoutIndex(x, y - 1) == layoutStepLeft(index, y));
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestMapLayout );
@@ -0,0 +1,145 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <thread>
+
+#include "Map.h"
+#include "MapSnapshots.h"
+
+class TestMapSnapshots : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestMapSnapshots);
+  CPPUNIT_TEST(testInitialSnapshot);
+  CPPUNIT_TEST(testPublishAndRefresh);
+  CPPUNIT_TEST(testLatestPublishWins);
+  CPPUNIT_TEST(testPlannerOwnsSnapshot);
+  CPPUNIT_TEST(testConcurrentSnapshotsAreConsistent);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testInitialSnapshot(void);
+    void testPublishAndRefresh(void);
+    void testLatestPublishWins(void);
+    void testPlannerOwnsSnapshot(void);
+    void testConcurrentSnapshotsAreConsistent(void);
+
+  private:
+    MapSnapshots *mSnapshots;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestMapSnapshots::testInitialSnapshot(void) {
+  CPPUNIT_ASSERT(! mSnapshots->refresh());
+  CPPUNIT_ASSERT(10 == mSnapshots->snapshot().getSizeX());
+  CPPUNIT_ASSERT(NOTHING == mSnapshots->snapshot().getValue(5, 5));
+}
+
+void TestMapSnapshots::testPublishAndRefresh(void) {
+  mSnapshots->working().placeValue(5, 5, WALL);
+  CPPUNIT_ASSERT(! mSnapshots->refresh());
+  CPPUNIT_ASSERT(NOTHING == mSnapshots->snapshot().getValue(5, 5));
+
+  mSnapshots->publish();
+  CPPUNIT_ASSERT(NOTHING == mSnapshots->snapshot().getValue(5, 5));
+  CPPUNIT_ASSERT(mSnapshots->refresh());
+  CPPUNIT_ASSERT(WALL == mSnapshots->snapshot().getValue(5, 5));
+  CPPUNIT_ASSERT(mSnapshots->working().getObstacleHash() ==
+                 mSnapshots->snapshot().getObstacleHash());
+
+  // Nothing new since
+  CPPUNIT_ASSERT(! mSnapshots->refresh());
+  CPPUNIT_ASSERT(WALL == mSnapshots->snapshot().getValue(5, 5));
+}
+
+void TestMapSnapshots::testLatestPublishWins(void) {
+  mSnapshots->working().placeValue(1, 1, WALL);
+  mSnapshots->publish();
+  mSnapshots->working().placeValue(2, 2, WALL);
+  mSnapshots->publish();
+  mSnapshots->working().placeValue(3, 3, WALL);
+  mSnapshots->publish();
+
+  CPPUNIT_ASSERT(mSnapshots->refresh());
+  CPPUNIT_ASSERT(WALL == mSnapshots->snapshot().getValue(1, 1));
+  CPPUNIT_ASSERT(WALL == mSnapshots->snapshot().getValue(2, 2));
+  CPPUNIT_ASSERT(WALL == mSnapshots->snapshot().getValue(3, 3));
+  CPPUNIT_ASSERT(! mSnapshots->refresh());
+}
+
+void TestMapSnapshots::testPlannerOwnsSnapshot(void) {
+  mSnapshots->working().placeValue(4, 0, ROBOT);
+  mSnapshots->working().placeValue(4, 9, GOAL);
+  mSnapshots->publish();
+  mSnapshots->refresh();
+
+  CPPUNIT_ASSERT(RIGHT == mSnapshots->snapshot().propagateWavefront(NULL));
+
+  // Propagation values stay in the planner's copy
+  CPPUNIT_ASSERT(2 == mSnapshots->snapshot().getValue(4, 8));
+  CPPUNIT_ASSERT(NOTHING == mSnapshots->working().getValue(4, 8));
+
+  // Writer keeps going while the planner holds its snapshot
+  mSnapshots->working().placeValue(4, 1, WALL);
+  mSnapshots->publish();
+  CPPUNIT_ASSERT(2 == mSnapshots->snapshot().getValue(4, 8));
+  CPPUNIT_ASSERT(WALL != mSnapshots->snapshot().getValue(4, 1));
+  CPPUNIT_ASSERT(mSnapshots->refresh());
+  CPPUNIT_ASSERT(WALL == mSnapshots->snapshot().getValue(4, 1));
+}
+
+void TestMapSnapshots::testConcurrentSnapshotsAreConsistent(void) {
+  // The writer stamps the whole map with a generation number at a time;
+  // the reader must never see two generations mixed in one snapshot.
+  const int generations = 20000;
+  MapSnapshots *snapshots = mSnapshots;
+
+  std::thread writer([snapshots, generations]() {
+    for (int generation=1; generation<=generations; generation++) {
+      uint8_t value = 2 + generation % 200;
+      for (uint8_t x=0; x<10; x++) {
+        for (uint8_t y=0; y<10; y++) {
+          snapshots->working().placeValue(x, y, value);
+        }
+      }
+      snapshots->publish();
+    }
+  });
+
+  bool consistent = true;
+  int seen = 0;
+  while (seen < generations / 10 && consistent) {
+    if (! snapshots->refresh()) {
+      continue;
+    }
+    seen++;
+    Map& map = snapshots->snapshot();
+    uint8_t value = map.getValue(0, 0);
+    for (uint8_t x=0; x<10; x++) {
+      for (uint8_t y=0; y<10; y++) {
+        consistent = consistent && map.getValue(x, y) == value;
+      }
+    }
+    if (value == 2 + generations % 200) {
+      break;
+    }
+  }
+
+  writer.join();
+  CPPUNIT_ASSERT(consistent);
+}
+
+void TestMapSnapshots::setUp(void) {
+  mSnapshots = new MapSnapshots(DEFAULT_X_SIZE, DEFAULT_Y_SIZE);
+}
+
+void TestMapSnapshots::tearDown(void) {
+  delete mSnapshots;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestMapSnapshots );
@@ -0,0 +1,131 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "NextHopTable.h"
+
+class TestNextHopTable : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestNextHopTable);
+  CPPUNIT_TEST(testTableBytes);
+  CPPUNIT_TEST(testBufferTooSmall);
+  CPPUNIT_TEST(testMatchesDistanceField);
+  CPPUNIT_TEST(testWalkToGoal);
+  CPPUNIT_TEST(testUnreachable);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testTableBytes(void);
+    void testBufferTooSmall(void);
+    void testMatchesDistanceField(void);
+    void testWalkToGoal(void);
+    void testUnreachable(void);
+
+  private:
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+    uint8_t *mTable;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestNextHopTable::testTableBytes(void) {
+  CPPUNIT_ASSERT(2602 == NEXT_HOP_TABLE_BYTES(10, 10));
+  CPPUNIT_ASSERT(2 + 6 + 9 == NEXT_HOP_TABLE_BYTES(2, 3));
+}
+
+void TestNextHopTable::testBufferTooSmall(void) {
+  CPPUNIT_ASSERT(! NextHopTable::build(*mMap, mTable, 100, *mField, *mQueue));
+}
+
+void TestNextHopTable::testMatchesDistanceField(void) {
+  CPPUNIT_ASSERT(NextHopTable::build(*mMap, mTable, NEXT_HOP_TABLE_BYTES(10, 10),
+                                     *mField, *mQueue));
+  NextHopTable table(mTable, true);
+  CPPUNIT_ASSERT(10 == table.getSizeX());
+  CPPUNIT_ASSERT(10 == table.getSizeY());
+
+  for (uint8_t goalX=0; goalX<10; goalX++) {
+    for (uint8_t goalY=0; goalY<10; goalY++) {
+      mField->compute(*mMap, goalX, goalY, *mQueue);
+      for (uint8_t x=0; x<10; x++) {
+        for (uint8_t y=0; y<10; y++) {
+          uint8_t expected = NOTHING;
+          if (mMap->getValue(goalX, goalY) != WALL && mMap->getValue(x, y) != WALL) {
+            expected = mField->directionFrom(x, y);
+          }
+          CPPUNIT_ASSERT(expected == table.nextHop(goalX, goalY, x, y));
+        }
+      }
+    }
+  }
+}
+
+void TestNextHopTable::testWalkToGoal(void) {
+  NextHopTable::build(*mMap, mTable, NEXT_HOP_TABLE_BYTES(10, 10), *mField, *mQueue);
+  NextHopTable table(mTable, false);
+
+  // Around the end of the wall in row 4
+  uint8_t x = 0;
+  uint8_t y = 0;
+  uint8_t steps = 0;
+  uint8_t direction;
+  while ((direction = table.nextHop(9, 0, x, y)) != NOTHING) {
+    switch (direction) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+    }
+    CPPUNIT_ASSERT(WALL != mMap->getValue(x, y));
+    steps++;
+  }
+  CPPUNIT_ASSERT(9 == x);
+  CPPUNIT_ASSERT(0 == y);
+  CPPUNIT_ASSERT(27 == steps);
+}
+
+void TestNextHopTable::testUnreachable(void) {
+  NextHopTable::build(*mMap, mTable, NEXT_HOP_TABLE_BYTES(10, 10), *mField, *mQueue);
+  NextHopTable table(mTable, false);
+
+  // The walled-in corner, a wall and off the map
+  CPPUNIT_ASSERT(NOTHING == table.nextHop(0, 9, 0, 0));
+  CPPUNIT_ASSERT(NOTHING == table.nextHop(0, 0, 0, 9));
+  CPPUNIT_ASSERT(NOTHING == table.nextHop(0, 0, 4, 0));
+  CPPUNIT_ASSERT(NOTHING == table.nextHop(4, 0, 0, 0));
+  CPPUNIT_ASSERT(NOTHING == table.nextHop(0, 0, 10, 0));
+  CPPUNIT_ASSERT(NOTHING == table.nextHop(0, 0, 0, 0));
+}
+
+void TestNextHopTable::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+  mTable = new uint8_t[NEXT_HOP_TABLE_BYTES(10, 10)];
+
+  // A wall across row 4 with a gap at the far end, and a boxed-in corner
+  for (uint8_t y=0; y<9; y++) {
+    mMap->placeValue(4, y, WALL);
+  }
+  mMap->placeValue(0, 8, WALL);
+  mMap->placeValue(1, 9, WALL);
+}
+
+void TestNextHopTable::tearDown(void) {
+  delete [] mTable;
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestNextHopTable );
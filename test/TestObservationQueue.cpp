@@ -0,0 +1,191 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <thread>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "Path.h"
+#include "ObservationQueue.h"
+
+class TestObservationQueue : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestObservationQueue);
+  CPPUNIT_TEST(testPushPop);
+  CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST(testDrainNothing);
+  CPPUNIT_TEST(testDrainOffPath);
+  CPPUNIT_TEST(testDrainOnPath);
+  CPPUNIT_TEST(testDrainOpening);
+  CPPUNIT_TEST(testDrainRange);
+  CPPUNIT_TEST(testDrainPath);
+  CPPUNIT_TEST(testConcurrentProducer);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testPushPop(void);
+    void testFull(void);
+    void testDrainNothing(void);
+    void testDrainOffPath(void);
+    void testDrainOnPath(void);
+    void testDrainOpening(void);
+    void testDrainRange(void);
+    void testDrainPath(void);
+    void testConcurrentProducer(void);
+
+  private:
+    Map *mMap;
+    CellQueue *mCells;
+    DistanceField *mPlan;
+    ObservationQueue *mQueue;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestObservationQueue::testPushPop(void) {
+  Observation observation;
+  CPPUNIT_ASSERT(! mQueue->pop(observation));
+
+  CPPUNIT_ASSERT(mQueue->pushCell(1, 2, WALL));
+  CPPUNIT_ASSERT(mQueue->pushRange(3, 4, 90, 50, WALL));
+
+  CPPUNIT_ASSERT(mQueue->pop(observation));
+  CPPUNIT_ASSERT(OBSERVATION_CELL == observation.kind);
+  CPPUNIT_ASSERT(1 == observation.x);
+  CPPUNIT_ASSERT(2 == observation.y);
+  CPPUNIT_ASSERT(WALL == observation.value);
+
+  CPPUNIT_ASSERT(mQueue->pop(observation));
+  CPPUNIT_ASSERT(OBSERVATION_RANGE == observation.kind);
+  CPPUNIT_ASSERT(90 == observation.angle);
+  CPPUNIT_ASSERT(50 == observation.range);
+
+  CPPUNIT_ASSERT(! mQueue->pop(observation));
+}
+
+void TestObservationQueue::testFull(void) {
+  for (uint8_t i=0; i<OBSERVATION_QUEUE_SIZE; i++) {
+    CPPUNIT_ASSERT(mQueue->pushCell(i, 0, WALL));
+  }
+  CPPUNIT_ASSERT(! mQueue->pushCell(0, 1, WALL));
+  CPPUNIT_ASSERT(1 == mQueue->getDropped());
+
+  Observation observation;
+  CPPUNIT_ASSERT(mQueue->pop(observation));
+  CPPUNIT_ASSERT(0 == observation.x);
+  CPPUNIT_ASSERT(mQueue->pushCell(0, 1, WALL));
+}
+
+void TestObservationQueue::testDrainNothing(void) {
+  CPPUNIT_ASSERT(OBSERVATIONS_NONE == mQueue->drain(*mMap, *mPlan, 4, 0));
+
+  // Re-sensing a known wall changes nothing
+  mQueue->pushCell(4, 4, WALL);
+  CPPUNIT_ASSERT(OBSERVATIONS_NONE == mQueue->drain(*mMap, *mPlan, 4, 0));
+}
+
+void TestObservationQueue::testDrainOffPath(void) {
+  // The plan from 4, 0 runs straight along row 4; rows 0 and 9 are far off
+  mQueue->pushCell(0, 0, WALL);
+  mQueue->pushCell(9, 9, WALL);
+
+  CPPUNIT_ASSERT(OBSERVATIONS_APPLIED == mQueue->drain(*mMap, *mPlan, 4, 0));
+  CPPUNIT_ASSERT(WALL == mMap->getValue(0, 0));
+  CPPUNIT_ASSERT(WALL == mMap->getValue(9, 9));
+}
+
+void TestObservationQueue::testDrainOnPath(void) {
+  mQueue->pushCell(0, 0, WALL);
+  mQueue->pushCell(5, 2, WALL);
+  CPPUNIT_ASSERT(OBSERVATIONS_AFFECT_PATH == mQueue->drain(*mMap, *mPlan, 4, 0));
+}
+
+void TestObservationQueue::testDrainOpening(void) {
+  mQueue->pushCell(4, 4, NOTHING);
+  CPPUNIT_ASSERT(OBSERVATIONS_AFFECT_PATH == mQueue->drain(*mMap, *mPlan, 4, 0));
+  CPPUNIT_ASSERT(NOTHING == mMap->getValue(4, 4));
+}
+
+void TestObservationQueue::testDrainRange(void) {
+  // Robot on 4, 0 seeing something one and a half cells to the right
+  mQueue->pushRange(4, 0, 90, 50, WALL);
+  CPPUNIT_ASSERT(OBSERVATIONS_APPLIED == mQueue->drain(*mMap, *mPlan, 9, 9));
+  CPPUNIT_ASSERT(WALL == mMap->getValue(4, 2));
+}
+
+void TestObservationQueue::testDrainPath(void) {
+  Path path;
+  uint16_t repairFrom = 0;
+  path.extract(*mPlan, 4, 0);
+
+  CPPUNIT_ASSERT(PATH_VALID == mQueue->drain(*mMap, path, repairFrom));
+  mQueue->pushCell(0, 0, WALL);
+  CPPUNIT_ASSERT(PATH_VALID == mQueue->drain(*mMap, path, repairFrom));
+
+  // The earliest blockage wins
+  mQueue->pushCell(5, 5, WALL);
+  mQueue->pushCell(5, 2, WALL);
+  CPPUNIT_ASSERT(PATH_REPAIR == mQueue->drain(*mMap, path, repairFrom));
+  CPPUNIT_ASSERT(2 == repairFrom);
+
+  mQueue->pushCell(5, 6, WALL);
+  mQueue->pushCell(4, 9, WALL);
+  CPPUNIT_ASSERT(PATH_REPLAN == mQueue->drain(*mMap, path, repairFrom));
+}
+
+void TestObservationQueue::testConcurrentProducer(void) {
+  const int count = 100000;
+  ObservationQueue *queue = mQueue;
+
+  std::thread producer([queue, count]() {
+    for (int i=0; i<count; i++) {
+      Observation observation = { OBSERVATION_CELL, (uint8_t)(i >> 8), (uint8_t)i, 0, 0, 0 };
+      while (! queue->push(observation)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  bool inOrder = true;
+  for (int i=0; i<count; ) {
+    Observation observation;
+    if (! queue->pop(observation)) {
+      continue;
+    }
+    inOrder = inOrder && observation.x == (uint8_t)(i >> 8) && observation.y == (uint8_t)i;
+    i++;
+  }
+
+  producer.join();
+  CPPUNIT_ASSERT(inOrder);
+}
+
+void TestObservationQueue::setUp(void) {
+  mMap = new Map();
+  mCells = new CellQueue();
+  mPlan = new DistanceField();
+  mQueue = new ObservationQueue();
+
+  // Robot on 4, 0 heading for 4, 9 past a wall sticking up from 4, 4
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  mMap->placeValue(4, 4, WALL);
+  mMap->placeValue(3, 4, WALL);
+  mPlan->compute(*mMap, 4, 9, *mCells);
+}
+
+void TestObservationQueue::tearDown(void) {
+  delete mQueue;
+  delete mPlan;
+  delete mCells;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestObservationQueue );
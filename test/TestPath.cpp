@@ -0,0 +1,244 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "Path.h"
+
+class TestPath : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestPath);
+  CPPUNIT_TEST(testExtract);
+  CPPUNIT_TEST(testExtractUnreachable);
+  CPPUNIT_TEST(testAdvance);
+  CPPUNIT_TEST(testCheckOffPath);
+  CPPUNIT_TEST(testCheckOnPath);
+  CPPUNIT_TEST(testCheckEnds);
+  CPPUNIT_TEST(testRepair);
+  CPPUNIT_TEST(testRepairAfterAdvance);
+  CPPUNIT_TEST(testRepairFails);
+  CPPUNIT_TEST(testRepairDoublesBack);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testExtract(void);
+    void testExtractUnreachable(void);
+    void testAdvance(void);
+    void testCheckOffPath(void);
+    void testCheckOnPath(void);
+    void testCheckEnds(void);
+    void testRepair(void);
+    void testRepairAfterAdvance(void);
+    void testRepairFails(void);
+    void testRepairDoublesBack(void);
+
+  private:
+    void plan(void);
+    bool reachesGoal(void);
+
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+    Path *mPath;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestPath::plan(void) {
+  mField->compute(*mMap, 4, 9, *mQueue);
+  mPath->extract(*mField, 4, 0);
+}
+
+/*
+ * Follows the path over the map and checks it ends on the goal without
+ * crossing a wall.
+ */
+bool TestPath::reachesGoal(void) {
+  uint8_t x = mPath->getStartX();
+  uint8_t y = mPath->getStartY();
+  for (uint16_t i=0; i<mPath->getLength(); i++) {
+    switch (mPath->getDirection(i)) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+      default: return false;
+    }
+    if (mMap->getValue(x, y) == WALL || ! mPath->contains(x, y)) {
+      return false;
+    }
+  }
+  return x == mPath->getGoalX() && y == mPath->getGoalY();
+}
+
+void TestPath::testExtract(void) {
+  plan();
+
+  CPPUNIT_ASSERT(9 == mPath->getLength());
+  CPPUNIT_ASSERT(RIGHT == mPath->getDirection(0));
+  CPPUNIT_ASSERT(RIGHT == mPath->getDirection(8));
+  CPPUNIT_ASSERT(NOTHING == mPath->getDirection(9));
+  CPPUNIT_ASSERT(mPath->contains(4, 0));
+  CPPUNIT_ASSERT(mPath->contains(4, 9));
+  CPPUNIT_ASSERT(! mPath->contains(5, 5));
+  CPPUNIT_ASSERT(reachesGoal());
+}
+
+void TestPath::testExtractUnreachable(void) {
+  mMap->placeValue(3, 9, WALL);
+  mMap->placeValue(5, 9, WALL);
+  mMap->placeValue(4, 8, WALL);
+  plan();
+
+  CPPUNIT_ASSERT(0 == mPath->getLength());
+  CPPUNIT_ASSERT(! mPath->contains(4, 0));
+}
+
+void TestPath::testAdvance(void) {
+  plan();
+  mPath->advance();
+
+  CPPUNIT_ASSERT(8 == mPath->getLength());
+  CPPUNIT_ASSERT(4 == mPath->getStartX());
+  CPPUNIT_ASSERT(1 == mPath->getStartY());
+  CPPUNIT_ASSERT(! mPath->contains(4, 0));
+  CPPUNIT_ASSERT(reachesGoal());
+}
+
+void TestPath::testCheckOffPath(void) {
+  plan();
+  uint16_t repairFrom = 1234;
+
+  mMap->placeValue(0, 0, WALL);
+  CPPUNIT_ASSERT(PATH_VALID == mPath->check(*mMap, 0, 0, repairFrom));
+
+  // Still open, so still fine
+  mMap->placeValue(4, 5, 17);
+  CPPUNIT_ASSERT(PATH_VALID == mPath->check(*mMap, 4, 5, repairFrom));
+  CPPUNIT_ASSERT(1234 == repairFrom);
+}
+
+void TestPath::testCheckOnPath(void) {
+  plan();
+  uint16_t repairFrom;
+
+  mMap->placeValue(4, 5, WALL);
+  CPPUNIT_ASSERT(PATH_REPAIR == mPath->check(*mMap, 4, 5, repairFrom));
+  CPPUNIT_ASSERT(4 == repairFrom);
+
+  mMap->placeValue(4, 1, UNKNOWN);
+  CPPUNIT_ASSERT(PATH_REPAIR == mPath->check(*mMap, 4, 1, repairFrom));
+  CPPUNIT_ASSERT(0 == repairFrom);
+}
+
+void TestPath::testCheckEnds(void) {
+  plan();
+  uint16_t repairFrom;
+
+  mMap->placeValue(4, 9, WALL);
+  CPPUNIT_ASSERT(PATH_REPLAN == mPath->check(*mMap, 4, 9, repairFrom));
+  mMap->placeValue(4, 0, WALL);
+  CPPUNIT_ASSERT(PATH_REPLAN == mPath->check(*mMap, 4, 0, repairFrom));
+}
+
+void TestPath::testRepair(void) {
+  plan();
+  uint16_t repairFrom;
+
+  mMap->placeValue(4, 5, WALL);
+  mPath->check(*mMap, 4, 5, repairFrom);
+  CPPUNIT_ASSERT(mPath->repair(*mMap, repairFrom, *mField, *mQueue));
+
+  // Four moves kept, then around the new wall
+  CPPUNIT_ASSERT(11 == mPath->getLength());
+  CPPUNIT_ASSERT(RIGHT == mPath->getDirection(3));
+  CPPUNIT_ASSERT(mPath->contains(4, 4));
+  CPPUNIT_ASSERT(! mPath->contains(4, 5));
+  CPPUNIT_ASSERT(reachesGoal());
+}
+
+void TestPath::testRepairAfterAdvance(void) {
+  plan();
+  mPath->advance();
+  mPath->advance();
+  uint16_t repairFrom;
+
+  mMap->placeValue(4, 7, WALL);
+  CPPUNIT_ASSERT(PATH_REPAIR == mPath->check(*mMap, 4, 7, repairFrom));
+  CPPUNIT_ASSERT(4 == repairFrom);
+  CPPUNIT_ASSERT(mPath->repair(*mMap, repairFrom, *mField, *mQueue));
+
+  CPPUNIT_ASSERT(9 == mPath->getLength());
+  CPPUNIT_ASSERT(4 == mPath->getStartX());
+  CPPUNIT_ASSERT(2 == mPath->getStartY());
+  CPPUNIT_ASSERT(! mPath->contains(4, 1));
+  CPPUNIT_ASSERT(reachesGoal());
+}
+
+void TestPath::testRepairFails(void) {
+  plan();
+  uint16_t repairFrom;
+
+  mMap->placeValue(3, 9, WALL);
+  mMap->placeValue(5, 9, WALL);
+  mMap->placeValue(4, 8, WALL);
+  CPPUNIT_ASSERT(PATH_REPAIR == mPath->check(*mMap, 4, 8, repairFrom));
+  CPPUNIT_ASSERT(! mPath->repair(*mMap, repairFrom, *mField, *mQueue));
+  CPPUNIT_ASSERT(0 == mPath->getLength());
+}
+
+void TestPath::testRepairDoublesBack(void) {
+  // Row 1 is walled but for a gap at each end
+  for (uint8_t y=0; y<10; y++) {
+    if (y != 0 && y != 5) {
+      mMap->placeValue(1, y, WALL);
+    }
+  }
+  mField->compute(*mMap, 0, 5, *mQueue);
+  mPath->extract(*mField, 0, 2);
+  uint16_t repairFrom;
+
+  // The way on from 0, 3 now goes back past the robot
+  mMap->placeValue(0, 4, WALL);
+  CPPUNIT_ASSERT(PATH_REPAIR == mPath->check(*mMap, 0, 4, repairFrom));
+  CPPUNIT_ASSERT(1 == repairFrom);
+  CPPUNIT_ASSERT(mPath->repair(*mMap, repairFrom, *mField, *mQueue));
+
+  CPPUNIT_ASSERT(LEFT == mPath->getDirection(0));
+  CPPUNIT_ASSERT(! mPath->contains(0, 3));
+  CPPUNIT_ASSERT(reachesGoal());
+
+  // Every cell still ahead stays on the bitmap
+  mPath->advance();
+  CPPUNIT_ASSERT(! mPath->contains(0, 2));
+  CPPUNIT_ASSERT(reachesGoal());
+  mMap->placeValue(0, 0, WALL);
+  CPPUNIT_ASSERT(PATH_REPAIR == mPath->check(*mMap, 0, 0, repairFrom));
+}
+
+void TestPath::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+  mPath = new Path();
+
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+}
+
+void TestPath::tearDown(void) {
+  delete mPath;
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestPath );
@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "PlanArena.h"
+
+class TestPlanArena : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestPlanArena);
+  CPPUNIT_TEST(testTake);
+  CPPUNIT_TEST(testAlign);
+  CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST(testRelease);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testTake(void);
+    void testAlign(void);
+    void testFull(void);
+    void testRelease(void);
+
+  private:
+    uint8_t mBuffer[64];
+};
+
+//-----------------------------------------------------------------------------
+
+void TestPlanArena::testTake(void) {
+  PlanArena arena(mBuffer, sizeof(mBuffer));
+  CPPUNIT_ASSERT(64 == arena.getSize());
+  CPPUNIT_ASSERT(0 == arena.getUsed());
+
+  uint8_t *a = (uint8_t *)arena.take(8);
+  uint8_t *b = (uint8_t *)arena.take(8);
+  CPPUNIT_ASSERT(a != NULL && b != NULL);
+  CPPUNIT_ASSERT(a >= mBuffer && b + 8 <= mBuffer + sizeof(mBuffer));
+  CPPUNIT_ASSERT(b >= a + 8);
+  CPPUNIT_ASSERT(arena.getUsed() >= 16);
+}
+
+void TestPlanArena::testAlign(void) {
+  // However badly the buffer and the blocks before are aligned
+  for (uint8_t offset=0; offset<PLAN_ARENA_ALIGN; offset++) {
+    PlanArena arena(mBuffer + offset, sizeof(mBuffer) - offset);
+    for (uint8_t bytes=1; bytes<=5; bytes++) {
+      uint32_t before = arena.getUsed();
+      uint8_t *block = (uint8_t *)arena.take(bytes);
+      CPPUNIT_ASSERT(block != NULL);
+      CPPUNIT_ASSERT(0 == (uintptr_t)block % PLAN_ARENA_ALIGN);
+      CPPUNIT_ASSERT(arena.getUsed() - before <= PLAN_ARENA_SPACE(bytes));
+    }
+  }
+}
+
+void TestPlanArena::testFull(void) {
+  PlanArena arena(mBuffer, sizeof(mBuffer));
+  CPPUNIT_ASSERT(NULL == arena.take(65));
+  CPPUNIT_ASSERT(0 == arena.getUsed());
+
+  CPPUNIT_ASSERT(NULL != arena.take(60));
+  uint32_t used = arena.getUsed();
+  CPPUNIT_ASSERT(NULL == arena.take(8));
+  CPPUNIT_ASSERT(used == arena.getUsed());
+}
+
+void TestPlanArena::testRelease(void) {
+  PlanArena arena(mBuffer, sizeof(mBuffer));
+  arena.take(8);
+  uint32_t top = arena.mark();
+  void *block = arena.take(40);
+  uint32_t peak = arena.getUsed();
+
+  arena.release(top);
+  CPPUNIT_ASSERT(top == arena.getUsed());
+  CPPUNIT_ASSERT(peak == arena.getPeak());
+  CPPUNIT_ASSERT(block == arena.take(40));
+
+  arena.reset();
+  CPPUNIT_ASSERT(0 == arena.getUsed());
+  CPPUNIT_ASSERT(peak == arena.getPeak());
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestPlanArena );
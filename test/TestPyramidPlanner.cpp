@@ -0,0 +1,122 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "Path.h"
+#include "PyramidPlanner.h"
+
+class TestPyramidPlanner : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestPyramidPlanner);
+  CPPUNIT_TEST(testMatchesField);
+  CPPUNIT_TEST(testWallBesideGoal);
+  CPPUNIT_TEST(testNarrowGapFallsBack);
+  CPPUNIT_TEST(testNoPath);
+  CPPUNIT_TEST(testRebuild);
+  CPPUNIT_TEST(testMissingGoal);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testMatchesField(void);
+    void testWallBesideGoal(void);
+    void testNarrowGapFallsBack(void);
+    void testNoPath(void);
+    void testRebuild(void);
+    void testMissingGoal(void);
+
+  private:
+    Map *mMap;
+    PyramidPlanner *mPlanner;
+    CellQueue *mQueue;
+    DistanceField *mField;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestPyramidPlanner::testMatchesField(void) {
+  mMap->placeValue(3, 4, WALL);
+  mMap->placeValue(4, 4, WALL);
+  mMap->placeValue(5, 4, WALL);
+
+  mField->compute(*mMap, 4, 9, *mQueue);
+  CPPUNIT_ASSERT(mField->directionFrom(4, 0) == mPlanner->plan(*mMap));
+  CPPUNIT_ASSERT(mField->getValue(4, 0) == mPlanner->getField().getValue(4, 0));
+  CPPUNIT_ASSERT(0 == mPlanner->getFallbacks());
+
+  // Every step along the way agrees as well
+  Path path;
+  CPPUNIT_ASSERT(path.extract(mPlanner->getField(), 4, 0));
+  CPPUNIT_ASSERT(mField->getValue(4, 0) - GOAL == path.getLength());
+}
+
+void TestPyramidPlanner::testWallBesideGoal(void) {
+  // Blocks the coarse cells holding the goal and the robot
+  mMap->placeValue(5, 9, WALL);
+  mMap->placeValue(5, 0, WALL);
+
+  CPPUNIT_ASSERT(RIGHT == mPlanner->plan(*mMap));
+  CPPUNIT_ASSERT(0 == mPlanner->getFallbacks());
+}
+
+void TestPyramidPlanner::testNarrowGapFallsBack(void) {
+  // Every coarse cell across the middle is blocked
+  for (uint8_t x=0; x<10; x++) {
+    if (x != 7) {
+      mMap->placeValue(x, 4, WALL);
+    }
+  }
+
+  CPPUNIT_ASSERT(DOWN == mPlanner->plan(*mMap));
+  CPPUNIT_ASSERT(1 == mPlanner->getFallbacks());
+  CPPUNIT_ASSERT(16 == mPlanner->getField().getValue(4, 0));
+}
+
+void TestPyramidPlanner::testNoPath(void) {
+  for (uint8_t x=0; x<10; x++) {
+    mMap->placeValue(x, 4, WALL);
+  }
+
+  CPPUNIT_ASSERT(NOTHING == mPlanner->plan(*mMap));
+}
+
+void TestPyramidPlanner::testRebuild(void) {
+  CPPUNIT_ASSERT(RIGHT == mPlanner->plan(*mMap));
+
+  mMap->placeValue(4, 1, WALL);
+  CPPUNIT_ASSERT(DOWN == mPlanner->plan(*mMap));
+  CPPUNIT_ASSERT(NOTHING == mPlanner->plan(*mMap, 4, 0, 4, 1));
+  CPPUNIT_ASSERT(LEFT == mPlanner->plan(*mMap, 4, 9, 4, 2));
+}
+
+void TestPyramidPlanner::testMissingGoal(void) {
+  mMap->placeValue(4, 9, NOTHING);
+  CPPUNIT_ASSERT(NOTHING == mPlanner->plan(*mMap));
+}
+
+void TestPyramidPlanner::setUp(void) {
+  mMap = new Map();
+  mPlanner = new PyramidPlanner();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+}
+
+void TestPyramidPlanner::tearDown(void) {
+  delete mField;
+  delete mQueue;
+  delete mPlanner;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestPyramidPlanner );
@@ -0,0 +1,102 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ReservationTable.h"
+
+class TestReservationTable : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestReservationTable);
+  CPPUNIT_TEST(testReserve);
+  CPPUNIT_TEST(testHorizon);
+  CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST(testSafeInterval);
+  CPPUNIT_TEST(testAdvance);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testReserve(void);
+    void testHorizon(void);
+    void testFull(void);
+    void testSafeInterval(void);
+    void testAdvance(void);
+};
+
+//-----------------------------------------------------------------------------
+
+void TestReservationTable::testReserve(void) {
+  ReservationTable table;
+  CPPUNIT_ASSERT(table.reserve(3, 4, 2, 5));
+  CPPUNIT_ASSERT(1 == table.getCount());
+  CPPUNIT_ASSERT(! table.isReserved(3, 4, 1));
+  CPPUNIT_ASSERT(table.isReserved(3, 4, 2));
+  CPPUNIT_ASSERT(table.isReserved(3, 4, 4));
+  CPPUNIT_ASSERT(! table.isReserved(3, 4, 5));
+  CPPUNIT_ASSERT(! table.isReserved(4, 3, 3));
+
+  table.clear();
+  CPPUNIT_ASSERT(0 == table.getCount());
+  CPPUNIT_ASSERT(! table.isReserved(3, 4, 2));
+}
+
+void TestReservationTable::testHorizon(void) {
+  ReservationTable table;
+  CPPUNIT_ASSERT(table.reserve(1, 1, TIMED_HORIZON - 1, TIMED_HORIZON + 10));
+  CPPUNIT_ASSERT(table.isReserved(1, 1, TIMED_HORIZON - 1));
+  CPPUNIT_ASSERT(! table.isReserved(1, 1, TIMED_HORIZON));
+
+  // Nothing left of it
+  CPPUNIT_ASSERT(table.reserve(1, 1, TIMED_HORIZON, TIMED_HORIZON + 10));
+  CPPUNIT_ASSERT(1 == table.getCount());
+}
+
+void TestReservationTable::testFull(void) {
+  ReservationTable table;
+  for (uint8_t i=0; i<RESERVATION_TABLE_SIZE; i++) {
+    CPPUNIT_ASSERT(table.reserve(i, 0, 0, 1));
+  }
+  CPPUNIT_ASSERT(! table.reserve(0, 1, 0, 1));
+  CPPUNIT_ASSERT(RESERVATION_TABLE_SIZE == table.getCount());
+}
+
+void TestReservationTable::testSafeInterval(void) {
+  ReservationTable table;
+  table.reserve(2, 2, 3, 6);
+  table.reserve(2, 2, 5, 8);
+  table.reserve(2, 2, 8, 9);
+  table.reserve(2, 2, 12, 14);
+  uint16_t start;
+  uint16_t end;
+
+  table.safeInterval(2, 2, 0, start, end);
+  CPPUNIT_ASSERT(0 == start && 3 == end);
+
+  // Overlapping and touching windows are one
+  table.safeInterval(2, 2, 4, start, end);
+  CPPUNIT_ASSERT(9 == start && 12 == end);
+
+  table.safeInterval(2, 2, 13, start, end);
+  CPPUNIT_ASSERT(14 == start && SAFE_FOREVER == end);
+
+  table.safeInterval(7, 7, 4, start, end);
+  CPPUNIT_ASSERT(4 == start && SAFE_FOREVER == end);
+}
+
+void TestReservationTable::testAdvance(void) {
+  ReservationTable table;
+  table.reserve(1, 1, 0, 2);
+  table.reserve(2, 2, 1, 6);
+  table.reserve(3, 3, 4, 6);
+
+  table.advance(2);
+  CPPUNIT_ASSERT(2 == table.getCount());
+  CPPUNIT_ASSERT(! table.isReserved(1, 1, 0));
+  CPPUNIT_ASSERT(table.isReserved(2, 2, 0));
+  CPPUNIT_ASSERT(table.isReserved(2, 2, 3));
+  CPPUNIT_ASSERT(! table.isReserved(2, 2, 4));
+  CPPUNIT_ASSERT(! table.isReserved(3, 3, 1));
+  CPPUNIT_ASSERT(table.isReserved(3, 3, 2));
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestReservationTable );
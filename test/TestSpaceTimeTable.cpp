@@ -0,0 +1,79 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "SpaceTimeTable.h"
+
+class TestSpaceTimeTable : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestSpaceTimeTable);
+  CPPUNIT_TEST(testReserve);
+  CPPUNIT_TEST(testPark);
+  CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST(testClear);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testReserve(void);
+    void testPark(void);
+    void testFull(void);
+    void testClear(void);
+};
+
+//-----------------------------------------------------------------------------
+
+void TestSpaceTimeTable::testReserve(void) {
+  SpaceTimeTable table;
+  CPPUNIT_ASSERT(NO_ROBOT == table.owner(2, 3, 4));
+  CPPUNIT_ASSERT(table.reserve(2, 3, 4, 7));
+  CPPUNIT_ASSERT(7 == table.owner(2, 3, 4));
+  CPPUNIT_ASSERT(NO_ROBOT == table.owner(2, 3, 5));
+  CPPUNIT_ASSERT(NO_ROBOT == table.owner(3, 2, 4));
+
+  // Taken by someone else, but the holder may ask again
+  CPPUNIT_ASSERT(! table.reserve(2, 3, 4, 8));
+  CPPUNIT_ASSERT(table.reserve(2, 3, 4, 7));
+  CPPUNIT_ASSERT(1 == table.getCount());
+  CPPUNIT_ASSERT(4 == table.getLastTime());
+}
+
+void TestSpaceTimeTable::testPark(void) {
+  SpaceTimeTable table;
+  CPPUNIT_ASSERT(SPACE_TIME_PARKED == table.parkedSince(5, 5));
+  CPPUNIT_ASSERT(table.park(5, 5, 10, 2));
+  CPPUNIT_ASSERT(10 == table.parkedSince(5, 5));
+  CPPUNIT_ASSERT(NO_ROBOT == table.owner(5, 5, 9));
+  CPPUNIT_ASSERT(2 == table.owner(5, 5, 10));
+  CPPUNIT_ASSERT(2 == table.owner(5, 5, 1000));
+  CPPUNIT_ASSERT(! table.park(5, 5, 20, 3));
+}
+
+void TestSpaceTimeTable::testFull(void) {
+  SpaceTimeTable table;
+  uint16_t room = SPACE_TIME_SLOTS * 3 / 4;
+  CPPUNIT_ASSERT(table.hasRoom(room));
+  CPPUNIT_ASSERT(! table.hasRoom(room + 1));
+
+  for (uint16_t t=0; t<room; t++) {
+    CPPUNIT_ASSERT(table.reserve(1, 1, t, 0));
+  }
+  CPPUNIT_ASSERT(! table.reserve(1, 1, room, 0));
+  CPPUNIT_ASSERT(! table.park(1, 1, room, 0));
+  for (uint16_t t=0; t<room; t++) {
+    CPPUNIT_ASSERT(0 == table.owner(1, 1, t));
+  }
+}
+
+void TestSpaceTimeTable::testClear(void) {
+  SpaceTimeTable table;
+  table.reserve(1, 2, 3, 0);
+  table.park(4, 5, 6, 1);
+  table.clear();
+  CPPUNIT_ASSERT(0 == table.getCount());
+  CPPUNIT_ASSERT(0 == table.getLastTime());
+  CPPUNIT_ASSERT(NO_ROBOT == table.owner(1, 2, 3));
+  CPPUNIT_ASSERT(NO_ROBOT == table.owner(4, 5, 6));
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestSpaceTimeTable );
@@ -0,0 +1,234 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "ReservationTable.h"
+#include "PlanArena.h"
+#include "TimedPlanner.h"
+
+class TestTimedPlanner : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestTimedPlanner);
+  CPPUNIT_TEST(testNoReservations);
+  CPPUNIT_TEST(testWaitAtChokepoint);
+  CPPUNIT_TEST(testSidestep);
+  CPPUNIT_TEST(testNoSwap);
+  CPPUNIT_TEST(testGoalTakenForAWhile);
+  CPPUNIT_TEST(testPastHorizon);
+  CPPUNIT_TEST(testRobotCellTaken);
+  CPPUNIT_TEST(testUnreachable);
+  CPPUNIT_TEST(testArenaReleased);
+  CPPUNIT_TEST(testArenaTooSmall);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testNoReservations(void);
+    void testWaitAtChokepoint(void);
+    void testSidestep(void);
+    void testNoSwap(void);
+    void testGoalTakenForAWhile(void);
+    void testPastHorizon(void);
+    void testRobotCellTaken(void);
+    void testUnreachable(void);
+    void testArenaReleased(void);
+    void testArenaTooSmall(void);
+
+  private:
+    boolean plan(uint8_t robotX, uint8_t robotY, uint8_t goalX, uint8_t goalY);
+    boolean safe(uint8_t robotX, uint8_t robotY, uint8_t goalX, uint8_t goalY);
+    uint16_t waits(void);
+
+    Map *mMap;
+    CellQueue *mQueue;
+    DistanceField *mField;
+    ReservationTable *mTable;
+    uint8_t mScratch[TIMED_PLANNER_ARENA];
+    PlanArena *mArena;
+    TimedPlanner *mPlanner;
+};
+
+//-----------------------------------------------------------------------------
+
+boolean TestTimedPlanner::plan(uint8_t robotX, uint8_t robotY, uint8_t goalX, uint8_t goalY) {
+  mField->compute(*mMap, goalX, goalY, *mQueue);
+  return mPlanner->plan(*mMap, *mField, *mTable, robotX, robotY);
+}
+
+/*
+ * Plays the plan back, checking that it never enters a wall or a
+ * reserved cell, never swaps places with a reservation, and ends on the
+ * goal.
+ */
+boolean TestTimedPlanner::safe(uint8_t robotX, uint8_t robotY, uint8_t goalX, uint8_t goalY) {
+  uint8_t x = robotX;
+  uint8_t y = robotY;
+  for (uint16_t t=0; t<mPlanner->getLength(); t++) {
+    uint8_t lastX = x;
+    uint8_t lastY = y;
+    switch (mPlanner->getMove(t)) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+      case WAIT: break;
+      default: return false;
+    }
+    if (! mMap->coordinateInRange(x, y) || mMap->getValue(x, y) == WALL) {
+      return false;
+    }
+    if (mTable->isReserved(x, y, t + 1)) {
+      return false;
+    }
+    if ((x != lastX || y != lastY) &&
+        mTable->isReserved(x, y, t) && mTable->isReserved(lastX, lastY, t + 1)) {
+      return false;
+    }
+  }
+  return x == goalX && y == goalY && NOTHING == mPlanner->getMove(mPlanner->getLength());
+}
+
+uint16_t TestTimedPlanner::waits(void) {
+  uint16_t count = 0;
+  for (uint16_t t=0; t<mPlanner->getLength(); t++) {
+    if (mPlanner->getMove(t) == WAIT) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void TestTimedPlanner::testNoReservations(void) {
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(9 == mPlanner->getLength());
+  CPPUNIT_ASSERT(RIGHT == mPlanner->getMove(0));
+  CPPUNIT_ASSERT(RIGHT == mPlanner->getMove(8));
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testWaitAtChokepoint(void) {
+  // Going round the walls costs more than waiting for the cell to clear
+  for (uint8_t x=0; x<10; x++) {
+    if (x != 4) {
+      mMap->placeValue(x, 3, WALL);
+    }
+  }
+  mTable->reserve(4, 3, 2, 6);
+
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(12 == mPlanner->getLength());
+  CPPUNIT_ASSERT(3 == waits());
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testSidestep(void) {
+  // Someone crossing the robot's row, one cell per step
+  for (uint8_t x=0; x<10; x++) {
+    mTable->reserve(x, 3, x, x + 1);
+  }
+  mTable->reserve(4, 3, 0, 8);
+
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+  CPPUNIT_ASSERT(mPlanner->getLength() <= 11);
+}
+
+void TestTimedPlanner::testNoSwap(void) {
+  // Someone walking the other way along a corridor
+  for (uint8_t x=0; x<10; x++) {
+    if (x != 4) {
+      mMap->placeValue(x, 5, WALL);
+    }
+  }
+  for (uint8_t y=0; y<6; y++) {
+    mTable->reserve(4, 9 - y, y, y + 1);
+  }
+
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testGoalTakenForAWhile(void) {
+  mTable->reserve(4, 9, 0, 15);
+
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(15 == mPlanner->getLength());
+  CPPUNIT_ASSERT(6 == waits());
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testPastHorizon(void) {
+  // The goal is taken until the horizon, so the plan waits that long
+  // and the rest is the field's
+  mTable->reserve(4, 1, 0, TIMED_HORIZON);
+
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+  CPPUNIT_ASSERT(11 == mPlanner->getLength());
+
+  mTable->clear();
+  mTable->reserve(4, 9, 0, 100);
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(TIMED_HORIZON == mPlanner->getLength());
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testRobotCellTaken(void) {
+  mTable->reserve(4, 0, 0, 2);
+  CPPUNIT_ASSERT(! plan(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testUnreachable(void) {
+  mMap->placeValue(3, 9, WALL);
+  mMap->placeValue(5, 9, WALL);
+  mMap->placeValue(4, 8, WALL);
+  CPPUNIT_ASSERT(! plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(! mPlanner->getExhausted());
+}
+
+void TestTimedPlanner::testArenaReleased(void) {
+  mTable->reserve(4, 5, 3, 6);
+  CPPUNIT_ASSERT(plan(4, 0, 4, 9));
+  CPPUNIT_ASSERT(0 == mArena->getUsed());
+  CPPUNIT_ASSERT(mArena->getPeak() > 0);
+  CPPUNIT_ASSERT(mArena->getPeak() <= TIMED_PLANNER_ARENA);
+
+  // The plan outlives the nodes it was found with
+  CPPUNIT_ASSERT(safe(4, 0, 4, 9));
+}
+
+void TestTimedPlanner::testArenaTooSmall(void) {
+  PlanArena arena(mScratch, TIMED_PLANNER_NODES * sizeof(TimedNode));
+  TimedPlanner planner(arena);
+  mField->compute(*mMap, 4, 9, *mQueue);
+  CPPUNIT_ASSERT(! planner.plan(*mMap, *mField, *mTable, 4, 0));
+  CPPUNIT_ASSERT(planner.getExhausted());
+  CPPUNIT_ASSERT(0 == arena.getUsed());
+}
+
+void TestTimedPlanner::setUp(void) {
+  mMap = new Map();
+  mQueue = new CellQueue();
+  mField = new DistanceField();
+  mTable = new ReservationTable();
+  mArena = new PlanArena(mScratch, sizeof(mScratch));
+  mPlanner = new TimedPlanner(*mArena);
+}
+
+void TestTimedPlanner::tearDown(void) {
+  delete mPlanner;
+  delete mArena;
+  delete mTable;
+  delete mField;
+  delete mQueue;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestTimedPlanner );
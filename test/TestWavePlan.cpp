@@ -0,0 +1,281 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Runs the waveplan tool itself (built by the test target) over maps
+ * written to a scratch directory and checks what it prints.
+ */
+class TestWavePlan : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestWavePlan);
+  CPPUNIT_TEST(testMapsInNameOrder);
+  CPPUNIT_TEST(testQueriesInInputOrder);
+  CPPUNIT_TEST(testIterationLimit);
+  CPPUNIT_TEST(testRejectedAndUnreadable);
+  CPPUNIT_TEST(testWavefrontMoves);
+  CPPUNIT_TEST(testJsonEscaping);
+  CPPUNIT_TEST(testCsvQuoting);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testMapsInNameOrder(void);
+    void testQueriesInInputOrder(void);
+    void testIterationLimit(void);
+    void testRejectedAndUnreadable(void);
+    void testWavefrontMoves(void);
+    void testJsonEscaping(void);
+    void testCsvQuoting(void);
+
+  private:
+    void write(const std::string& name, const std::string& text);
+    std::string open(uint8_t size);
+    std::string serpentine(uint8_t size);
+    std::vector<std::string> run(const std::string& arguments);
+    std::vector<std::string> split(const std::string& line);
+
+    std::string mDir;
+    std::string mSummary;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestWavePlan::write(const std::string& name, const std::string& text) {
+  std::ofstream out((mDir + "/" + name).c_str());
+  out << text;
+}
+
+/*
+ * An open square map with the robot and goal in opposite corners.
+ */
+std::string TestWavePlan::open(uint8_t size) {
+  std::string text;
+  for (uint8_t x=0; x<size; x++) {
+    std::string row(size, '.');
+    if (x == 0) {
+      row[0] = 'R';
+    }
+    if (x == size - 1) {
+      row[size - 1] = 'G';
+    }
+    text += row + "\n";
+  }
+  return text;
+}
+
+/*
+ * A single corridor winding across the whole map, far longer than
+ * Map::propagateWavefront() can follow.
+ */
+std::string TestWavePlan::serpentine(uint8_t size) {
+  std::string text;
+  for (uint8_t x=0; x<size; x++) {
+    std::string row(size, '.');
+    if (x & 1) {
+      row.assign(size, '#');
+      row[(x & 2) ? 0 : size - 1] = '.';
+    }
+    if (x == 0) {
+      row[0] = 'R';
+    }
+    if (x == size - 1) {
+      row[((size - 1) & 2) ? 0 : size - 1] = 'G';
+    }
+    text += row + "\n";
+  }
+  return text;
+}
+
+/*
+ * Runs waveplan, returning the lines it writes to stdout and keeping
+ * its summary line from stderr.
+ */
+std::vector<std::string> TestWavePlan::run(const std::string& arguments) {
+  std::string errors = mDir + "/stderr";
+  std::string command = "../tools/waveplan " + arguments + " 2>" + errors;
+  std::vector<std::string> lines;
+
+  FILE *out = popen(command.c_str(), "r");
+  CPPUNIT_ASSERT(out != NULL);
+  char buffer[4096];
+  while (fgets(buffer, sizeof(buffer), out)) {
+    std::string line(buffer);
+    if (! line.empty() && line[line.size() - 1] == '\n') {
+      line.erase(line.size() - 1);
+    }
+    lines.push_back(line);
+  }
+  pclose(out);
+
+  std::ifstream in(errors.c_str());
+  std::string line;
+  mSummary.clear();
+  while (std::getline(in, line)) {
+    mSummary = line;
+  }
+  return lines;
+}
+
+std::vector<std::string> TestWavePlan::split(const std::string& line) {
+  std::vector<std::string> fields;
+  std::istringstream in(line);
+  std::string field;
+  while (std::getline(in, field, ',')) {
+    fields.push_back(field);
+  }
+  if (! line.empty() && line[line.size() - 1] == ',') {
+    fields.push_back("");
+  }
+  return fields;
+}
+
+void TestWavePlan::testMapsInNameOrder(void) {
+  // The biggest maps come first, so with several threads they finish
+  // well after the small ones
+  for (unsigned i=0; i<16; i++) {
+    char name[16];
+    snprintf(name, sizeof(name), "m%02u.map", i);
+    write(name, open(240 - i * 14));
+  }
+
+  std::vector<std::string> lines = run("--threads 4 " + mDir);
+  CPPUNIT_ASSERT(17 == lines.size());
+  CPPUNIT_ASSERT(0 == lines[0].find("map,"));
+  for (unsigned i=0; i<16; i++) {
+    char prefix[64];
+    unsigned last = 240 - i * 14 - 1;
+    snprintf(prefix, sizeof(prefix), "/m%02u.map,0,0,%u,%u,", i, last, last);
+    CPPUNIT_ASSERT(lines[i + 1].find(prefix) != std::string::npos);
+  }
+}
+
+void TestWavePlan::testQueriesInInputOrder(void) {
+  write("big.map", open(200));
+  write("small.map", open(5));
+
+  // Queries on the two maps interleaved; each map is one job
+  std::string queries;
+  for (unsigned i=0; i<5; i++) {
+    std::ostringstream line;
+    line << "big.map " << i << " 0 199 199\n";
+    line << "small.map " << i << " 1 4 4\n";
+    queries += line.str();
+  }
+  write("queries", "; robot x varies with the line\n" + queries);
+
+  std::vector<std::string> lines = run("--threads 2 --queries " + mDir + "/queries");
+  CPPUNIT_ASSERT(11 == lines.size());
+  for (unsigned i=0; i<5; i++) {
+    std::ostringstream big;
+    big << "/big.map," << i << ",0,199,199,";
+    std::ostringstream small;
+    small << "/small.map," << i << ",1,4,4,";
+    CPPUNIT_ASSERT(lines[2 * i + 1].find(big.str()) != std::string::npos);
+    CPPUNIT_ASSERT(lines[2 * i + 2].find(small.str()) != std::string::npos);
+  }
+}
+
+void TestWavePlan::testIterationLimit(void) {
+  write("long.map", serpentine(21));
+
+  std::vector<std::string> lines = run("--engine wavefront " + mDir);
+  CPPUNIT_ASSERT(2 == lines.size());
+  CPPUNIT_ASSERT(lines[1].find(",none,-1,") != std::string::npos);
+  CPPUNIT_ASSERT(lines[1].find(",iteration limit reached") != std::string::npos);
+  CPPUNIT_ASSERT(mSummary.find("0 without a path, 1 at the iteration limit") != std::string::npos);
+
+  // The field has no such limit
+  lines = run("--engine field " + mDir);
+  CPPUNIT_ASSERT(lines[1].find(",right,240,") != std::string::npos);
+}
+
+void TestWavePlan::testRejectedAndUnreadable(void) {
+  write("walled.map", "R#?\n##.\n..G\n");
+  write("bad.map", "R.X\n");
+  write("queries", "walled.map 0 0 2 2\nwalled.map 0 0 0 1\nwalled.map 2 2 0 2\n"
+                   "walled.map 9 9 2 2\nbad.map 0 0 0 1\n");
+
+  std::vector<std::string> lines = run("--queries " + mDir + "/queries");
+  CPPUNIT_ASSERT(5 == lines.size());
+  CPPUNIT_ASSERT(lines[1].find(",none,-1,") != std::string::npos);
+  CPPUNIT_ASSERT(lines[2].find(",robot or goal on a blocked cell") != std::string::npos);
+  CPPUNIT_ASSERT(lines[3].find(",robot or goal on a blocked cell") != std::string::npos);
+  CPPUNIT_ASSERT(lines[4].find(",no robot or goal on the map") != std::string::npos);
+  CPPUNIT_ASSERT(mSummary.find("1 without a path, 0 at the iteration limit, 3 rejected, "
+                               "1 on unreadable maps") != std::string::npos);
+}
+
+void TestWavePlan::testWavefrontMoves(void) {
+  const char *rows[] = { "R.#...", ".##.#.", "...#..", ".#...G" };
+  std::string text;
+  for (unsigned x=0; x<4; x++) {
+    text += std::string(rows[x]) + "\n";
+  }
+  write("maze.map", text);
+
+  // map,robot_x,robot_y,goal_x,goal_y,direction,length,ns,moves,error
+  std::vector<std::string> lines = run("--engine wavefront --moves " + mDir);
+  CPPUNIT_ASSERT(2 == lines.size());
+  std::vector<std::string> fields = split(lines[1]);
+  CPPUNIT_ASSERT(10 == fields.size());
+  CPPUNIT_ASSERT("8" == fields[6]);
+  CPPUNIT_ASSERT(8 == fields[8].size());
+
+  // The moves lead from the robot to the goal without crossing a wall
+  int x = 0;
+  int y = 0;
+  for (size_t i=0; i<fields[8].size(); i++) {
+    switch (fields[8][i]) {
+      case 'D': x++; break;
+      case 'U': x--; break;
+      case 'R': y++; break;
+      case 'L': y--; break;
+      default: CPPUNIT_ASSERT(false);
+    }
+    CPPUNIT_ASSERT(x >= 0 && x < 4 && y >= 0 && y < 6);
+    CPPUNIT_ASSERT('#' != rows[x][y]);
+  }
+  CPPUNIT_ASSERT(3 == x && 5 == y);
+}
+
+void TestWavePlan::testJsonEscaping(void) {
+  write("a\"b\\c.map", "R.G\n");
+
+  std::vector<std::string> lines = run("--format json " + mDir);
+  CPPUNIT_ASSERT(1 == lines.size());
+  CPPUNIT_ASSERT(lines[0].find("a\\\"b\\\\c.map\"") != std::string::npos);
+}
+
+void TestWavePlan::testCsvQuoting(void) {
+  write("a,b\"c.map", "R.G\n");
+
+  std::vector<std::string> lines = run(mDir);
+  CPPUNIT_ASSERT(2 == lines.size());
+  CPPUNIT_ASSERT(0 == lines[1].find("\"" + mDir + "/a,b\"\"c.map\",0,0,0,2,right,2,"));
+}
+
+void TestWavePlan::setUp(void) {
+  char dir[] = "/tmp/testwaveplanXXXXXX";
+  CPPUNIT_ASSERT(mkdtemp(dir) != NULL);
+  mDir = dir;
+}
+
+void TestWavePlan::tearDown(void) {
+  std::string command = "rm -rf " + mDir;
+  if (system(command.c_str()) != 0) {
+    fprintf(stderr, "could not remove %s\n", mDir.c_str());
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestWavePlan );
@@ -0,0 +1,239 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string.h>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "WavefrontCache.h"
+
+class TestWavefrontCache : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestWavefrontCache);
+  CPPUNIT_TEST(testPlan);
+  CPPUNIT_TEST(testPlanWithoutGoal);
+  CPPUNIT_TEST(testHit);
+  CPPUNIT_TEST(testMissOnNewWall);
+  CPPUNIT_TEST(testHitAfterWallRemoved);
+  CPPUNIT_TEST(testEviction);
+  CPPUNIT_TEST(testInvalidate);
+  CPPUNIT_TEST(testHashCollision);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testPlan(void);
+    void testPlanWithoutGoal(void);
+    void testHit(void);
+    void testMissOnNewWall(void);
+    void testHitAfterWallRemoved(void);
+    void testEviction(void);
+    void testInvalidate(void);
+    void testHashCollision(void);
+
+  private:
+    uint32_t keyOf(uint8_t x, uint8_t y);
+    boolean collidingWalls(uint8_t x, uint8_t y, uint8_t *walls);
+
+    Map *mMap;
+    WavefrontCache *mCache;
+};
+
+//-----------------------------------------------------------------------------
+
+void TestWavefrontCache::testPlan(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  mMap->placeValue(3, 4, WALL);
+  mMap->placeValue(4, 4, WALL);
+  mMap->placeValue(5, 4, WALL);
+
+  CPPUNIT_ASSERT(DOWN == mCache->plan(*mMap));
+  CPPUNIT_ASSERT(NOTHING == mMap->getValue(3, 9));
+}
+
+void TestWavefrontCache::testPlanWithoutGoal(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  CPPUNIT_ASSERT(NOTHING == mCache->plan(*mMap));
+  CPPUNIT_ASSERT(0 == mCache->getMisses());
+}
+
+void TestWavefrontCache::testHit(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  mMap->placeValue(4, 4, WALL);
+
+  CPPUNIT_ASSERT(DOWN == mCache->plan(*mMap));
+  CPPUNIT_ASSERT(0 == mCache->getHits());
+  CPPUNIT_ASSERT(1 == mCache->getMisses());
+
+  // Robot moved, nothing new sensed
+  mMap->placeValue(4, 0, NOTHING);
+  mMap->placeValue(5, 0, ROBOT);
+
+  CPPUNIT_ASSERT(RIGHT == mCache->plan(*mMap));
+  CPPUNIT_ASSERT(1 == mCache->getHits());
+  CPPUNIT_ASSERT(1 == mCache->getMisses());
+}
+
+void TestWavefrontCache::testMissOnNewWall(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+
+  CPPUNIT_ASSERT(RIGHT == mCache->plan(*mMap));
+  mMap->placeValue(4, 1, WALL);
+  CPPUNIT_ASSERT(DOWN == mCache->plan(*mMap));
+  CPPUNIT_ASSERT(0 == mCache->getHits());
+  CPPUNIT_ASSERT(2 == mCache->getMisses());
+}
+
+void TestWavefrontCache::testHitAfterWallRemoved(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+
+  mCache->plan(*mMap);
+  mMap->placeValue(4, 1, WALL);
+  mCache->plan(*mMap);
+  mMap->placeValue(4, 1, NOTHING);
+
+  // Back to the original walls
+  CPPUNIT_ASSERT(RIGHT == mCache->plan(*mMap));
+  CPPUNIT_ASSERT(1 == mCache->getHits());
+}
+
+void TestWavefrontCache::testEviction(void) {
+  // Fill every entry, then touch the first goal so the second is oldest
+  for (uint8_t goal=0; goal<WAVEFRONT_CACHE_ENTRIES; goal++) {
+    mCache->lookup(*mMap, goal, 9);
+  }
+  mCache->lookup(*mMap, 0, 9);
+  CPPUNIT_ASSERT(1 == mCache->getHits());
+
+  mCache->lookup(*mMap, 9, 9);
+  CPPUNIT_ASSERT(WAVEFRONT_CACHE_ENTRIES + 1 == mCache->getMisses());
+
+  mCache->lookup(*mMap, 0, 9);
+  CPPUNIT_ASSERT(2 == mCache->getHits());
+  mCache->lookup(*mMap, 1, 9);
+  CPPUNIT_ASSERT(WAVEFRONT_CACHE_ENTRIES + 2 == mCache->getMisses());
+}
+
+void TestWavefrontCache::testInvalidate(void) {
+  DistanceField& field = mCache->lookup(*mMap, 5, 5);
+  CPPUNIT_ASSERT(GOAL == field.getValue(5, 5));
+
+  mCache->invalidate();
+  mCache->lookup(*mMap, 5, 5);
+  CPPUNIT_ASSERT(0 == mCache->getHits());
+  CPPUNIT_ASSERT(2 == mCache->getMisses());
+}
+
+/*
+ * The obstacle hash of a map holding just the one wall.
+ */
+uint32_t TestWavefrontCache::keyOf(uint8_t x, uint8_t y) {
+  Map map;
+  map.placeValue(x, y, WALL);
+  return map.getObstacleHash();
+}
+
+/*
+ * Finds cells, x, y among them, whose keys XOR to zero, so that walls on
+ * all of them leave the obstacle hash as it was; walls[] gets 1 for each
+ * of them. Row 4 is left open for the robot and goal. This is Gaussian
+ * elimination over the bits of the keys, with each basis key carrying
+ * the set of cells it was made from.
+ */
+boolean TestWavefrontCache::collidingWalls(uint8_t x, uint8_t y, uint8_t *walls) {
+  uint32_t basis[32];
+  uint8_t cells[32][CELL_COUNT];
+  memset(basis, 0, sizeof(basis));
+
+  for (uint8_t cx=0; cx<10; cx++) {
+    for (uint8_t cy=0; cy<10; cy++) {
+      if (cx == 4) {
+        continue;
+      }
+      uint32_t key = keyOf(cx, cy);
+      uint8_t made[CELL_COUNT];
+      memset(made, 0, sizeof(made));
+      made[cx * 10 + cy] = 1;
+      for (int8_t bit=31; bit>=0 && key; bit--) {
+        if (! (key >> bit & 1)) {
+          continue;
+        }
+        if (! basis[bit]) {
+          basis[bit] = key;
+          memcpy(cells[bit], made, sizeof(made));
+          key = 0;
+        } else {
+          key ^= basis[bit];
+          for (uint16_t i=0; i<CELL_COUNT; i++) {
+            made[i] ^= cells[bit][i];
+          }
+        }
+      }
+    }
+  }
+
+  uint32_t key = keyOf(x, y);
+  memset(walls, 0, CELL_COUNT);
+  walls[x * 10 + y] = 1;
+  for (int8_t bit=31; bit>=0; bit--) {
+    if (key >> bit & 1) {
+      if (! basis[bit]) {
+        return false;
+      }
+      key ^= basis[bit];
+      for (uint16_t i=0; i<CELL_COUNT; i++) {
+        walls[i] ^= cells[bit][i];
+      }
+    }
+  }
+  return true;
+}
+
+void TestWavefrontCache::testHashCollision(void) {
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  CPPUNIT_ASSERT(RIGHT == mCache->plan(*mMap));
+
+  // Walls that cancel out in the hash, one of them right of the robot
+  uint8_t walls[CELL_COUNT];
+  CPPUNIT_ASSERT(collidingWalls(4, 1, walls));
+  uint32_t hash = mMap->getObstacleHash();
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      if (walls[x * 10 + y]) {
+        mMap->placeValue(x, y, WALL);
+      }
+    }
+  }
+  CPPUNIT_ASSERT(hash == mMap->getObstacleHash());
+
+  // The cached field would lead into the wall; the plan must not
+  CellQueue queue;
+  DistanceField field;
+  field.compute(*mMap, 4, 9, queue);
+  uint8_t direction = mCache->plan(*mMap);
+  CPPUNIT_ASSERT(RIGHT != direction);
+  CPPUNIT_ASSERT(field.directionFrom(4, 0) == direction);
+}
+
+void TestWavefrontCache::setUp(void) {
+  mMap = new Map();
+  mCache = new WavefrontCache();
+}
+
+void TestWavefrontCache::tearDown(void) {
+  delete mCache;
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestWavefrontCache );
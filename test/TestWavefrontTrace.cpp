@@ -0,0 +1,169 @@
+#include <Arduino.h>
+#include <string.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWavefront.h"
+#include "Map.h"
+#include "WavefrontTrace.h"
+#include "WavefrontTraceReader.h"
+
+class TestWavefrontTrace : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestWavefrontTrace);
+  CPPUNIT_TEST(testFirstStepIsMap);
+  CPPUNIT_TEST(testReplayMatchesMap);
+  CPPUNIT_TEST(testCompact);
+  CPPUNIT_TEST(testOverflow);
+  CPPUNIT_TEST(testReset);
+  CPPUNIT_TEST(testNotATrace);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp(void);
+    void tearDown(void);
+
+  protected:
+    void testFirstStepIsMap(void);
+    void testReplayMatchesMap(void);
+    void testCompact(void);
+    void testOverflow(void);
+    void testReset(void);
+    void testNotATrace(void);
+
+  private:
+    uint16_t replay(const uint8_t *buffer, uint32_t length, uint32_t& cells);
+
+    Map *mMap;
+    uint8_t mBuffer[2048];
+    uint8_t mGrid[DEFAULT_X_SIZE][DEFAULT_Y_SIZE];
+};
+
+//-----------------------------------------------------------------------------
+
+/*
+ * Applies every step of the trace to mGrid, returning the number of
+ * steps and counting the cells relabeled.
+ */
+uint16_t TestWavefrontTrace::replay(const uint8_t *buffer, uint32_t length, uint32_t& cells) {
+  WavefrontTraceReader reader(buffer, length);
+  uint16_t steps = 0;
+  uint8_t x, y, value;
+
+  memset(mGrid, NOTHING, sizeof(mGrid));
+  cells = 0;
+  while (! reader.atEnd()) {
+    while (reader.nextCell(x, y, value)) {
+      mGrid[x][y] = value;
+      cells++;
+    }
+    steps++;
+  }
+  CPPUNIT_ASSERT(reader.isValid());
+  return steps;
+}
+
+void TestWavefrontTrace::testFirstStepIsMap(void) {
+  WavefrontTrace trace(mBuffer, sizeof(mBuffer));
+  mMap->propagateWavefront(&trace);
+
+  WavefrontTraceReader reader(mBuffer, trace.getLength());
+  CPPUNIT_ASSERT(reader.isValid());
+  CPPUNIT_ASSERT(10 == reader.getSizeX());
+  CPPUNIT_ASSERT(10 == reader.getSizeY());
+
+  uint8_t x, y, value;
+  CPPUNIT_ASSERT(reader.nextCell(x, y, value));
+  CPPUNIT_ASSERT(3 == x && 4 == y && WALL == value);
+  CPPUNIT_ASSERT(reader.nextCell(x, y, value));
+  CPPUNIT_ASSERT(4 == x && 0 == y && ROBOT == value);
+  CPPUNIT_ASSERT(reader.nextCell(x, y, value));
+  CPPUNIT_ASSERT(4 == x && 4 == y && WALL == value);
+  CPPUNIT_ASSERT(reader.nextCell(x, y, value));
+  CPPUNIT_ASSERT(4 == x && 9 == y && GOAL == value);
+  CPPUNIT_ASSERT(reader.nextCell(x, y, value));
+  CPPUNIT_ASSERT(5 == x && 4 == y && WALL == value);
+  CPPUNIT_ASSERT(! reader.nextCell(x, y, value));
+  CPPUNIT_ASSERT(! reader.atEnd());
+}
+
+void TestWavefrontTrace::testReplayMatchesMap(void) {
+  WavefrontTrace trace(mBuffer, sizeof(mBuffer));
+  CPPUNIT_ASSERT(DOWN == mMap->propagateWavefront(&trace));
+  CPPUNIT_ASSERT(! trace.getOverflow());
+
+  uint32_t cells;
+  CPPUNIT_ASSERT(trace.getSteps() == replay(mBuffer, trace.getLength(), cells));
+  for (uint8_t x=0; x<10; x++) {
+    for (uint8_t y=0; y<10; y++) {
+      CPPUNIT_ASSERT(mMap->getValue(x, y) == mGrid[x][y]);
+    }
+  }
+}
+
+void TestWavefrontTrace::testCompact(void) {
+  WavefrontTrace trace(mBuffer, sizeof(mBuffer));
+  mMap->propagateWavefront(&trace);
+
+  // Mostly one byte for the position and one for the value
+  uint32_t cells;
+  uint16_t steps = replay(mBuffer, trace.getLength(), cells);
+  CPPUNIT_ASSERT(trace.getLength() < WAVEFRONT_TRACE_HEADER + steps + cells * 5 / 2);
+}
+
+void TestWavefrontTrace::testOverflow(void) {
+  WavefrontTrace trace(mBuffer, 60);
+  mMap->propagateWavefront(&trace);
+  CPPUNIT_ASSERT(trace.getOverflow());
+  CPPUNIT_ASSERT(trace.getLength() <= 60);
+  CPPUNIT_ASSERT(trace.getSteps() > 0);
+
+  // Only whole steps are left
+  uint32_t cells;
+  CPPUNIT_ASSERT(trace.getSteps() == replay(mBuffer, trace.getLength(), cells));
+}
+
+void TestWavefrontTrace::testReset(void) {
+  WavefrontTrace trace(mBuffer, sizeof(mBuffer));
+  mMap->propagateWavefront(&trace);
+  uint32_t length = trace.getLength();
+  uint16_t steps = trace.getSteps();
+
+  trace.reset();
+  CPPUNIT_ASSERT(0 == trace.getLength());
+  mMap->propagateWavefront(&trace);
+  CPPUNIT_ASSERT(length == trace.getLength());
+  CPPUNIT_ASSERT(steps == trace.getSteps());
+}
+
+void TestWavefrontTrace::testNotATrace(void) {
+  const uint8_t junk[] = { 'W', 'X', 1, 10, 10, 0 };
+  WavefrontTraceReader reader(junk, sizeof(junk));
+  uint8_t x, y, value;
+  CPPUNIT_ASSERT(! reader.isValid());
+  CPPUNIT_ASSERT(reader.atEnd());
+  CPPUNIT_ASSERT(! reader.nextCell(x, y, value));
+
+  // A value cut off at the end of the buffer
+  const uint8_t cut[] = { 'W', 'T', 1, 10, 10, 1, 0x80 };
+  WavefrontTraceReader truncated(cut, sizeof(cut));
+  CPPUNIT_ASSERT(truncated.isValid());
+  CPPUNIT_ASSERT(! truncated.nextCell(x, y, value));
+  CPPUNIT_ASSERT(! truncated.isValid());
+}
+
+void TestWavefrontTrace::setUp(void) {
+  mMap = new Map();
+  mMap->placeValue(4, 0, ROBOT);
+  mMap->placeValue(4, 9, GOAL);
+  mMap->placeValue(3, 4, WALL);
+  mMap->placeValue(4, 4, WALL);
+  mMap->placeValue(5, 4, WALL);
+}
+
+void TestWavefrontTrace::tearDown(void) {
+  delete mMap;
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestWavefrontTrace );
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "WorkerPool.h"
+
+class TestWorkerPool : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(TestWorkerPool);
+  CPPUNIT_TEST(testThreads);
+  CPPUNIT_TEST(testEveryJobOnce);
+  CPPUNIT_TEST(testWorkersNotShared);
+  CPPUNIT_TEST(testFewerJobsThanThreads);
+  CPPUNIT_TEST(testNoJobs);
+  CPPUNIT_TEST_SUITE_END();
+
+  protected:
+    void testThreads(void);
+    void testEveryJobOnce(void);
+    void testWorkersNotShared(void);
+    void testFewerJobsThanThreads(void);
+    void testNoJobs(void);
+};
+
+//-----------------------------------------------------------------------------
+
+void TestWorkerPool::testThreads(void) {
+  CPPUNIT_ASSERT(3 == WorkerPool(3).getThreads());
+  CPPUNIT_ASSERT(WorkerPool(0).getThreads() >= 1);
+}
+
+void TestWorkerPool::testEveryJobOnce(void) {
+  WorkerPool pool(4);
+  std::vector<std::atomic<int> > calls(1000);
+  for (size_t i=0; i<calls.size(); i++) {
+    calls[i] = 0;
+  }
+
+  // Failed assertions cannot be thrown from the pool's threads
+  std::atomic<int> badWorkers(0);
+  pool.run(calls.size(), [&](unsigned worker, size_t index) {
+    if (worker >= 4) {
+      badWorkers++;
+    }
+    calls[index]++;
+  });
+
+  CPPUNIT_ASSERT(0 == badWorkers);
+
+  for (size_t i=0; i<calls.size(); i++) {
+    CPPUNIT_ASSERT(1 == calls[i]);
+  }
+}
+
+void TestWorkerPool::testWorkersNotShared(void) {
+  WorkerPool pool(4);
+  std::atomic<bool> busy[4];
+  std::atomic<int> clashes(0);
+  for (unsigned i=0; i<4; i++) {
+    busy[i] = false;
+  }
+
+  pool.run(400, [&](unsigned worker, size_t) {
+    if (busy[worker].exchange(true)) {
+      clashes++;
+    }
+    std::this_thread::yield();
+    busy[worker] = false;
+  });
+
+  CPPUNIT_ASSERT(0 == clashes);
+}
+
+void TestWorkerPool::testFewerJobsThanThreads(void) {
+  WorkerPool pool(8);
+  std::atomic<int> calls(0);
+  std::atomic<int> outOfRange(0);
+  pool.run(3, [&](unsigned worker, size_t index) {
+    if (worker >= 3 || index >= 3) {
+      outOfRange++;
+    }
+    calls++;
+  });
+  CPPUNIT_ASSERT(3 == calls);
+  CPPUNIT_ASSERT(0 == outOfRange);
+}
+
+void TestWorkerPool::testNoJobs(void) {
+  WorkerPool pool(4);
+  std::atomic<int> calls(0);
+  pool.run(0, [&](unsigned, size_t) {
+    calls++;
+  });
+  CPPUNIT_ASSERT(0 == calls);
+}
+
+//-----------------------------------------------------------------------------
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestWorkerPool );
@@ -0,0 +1,56 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Map.h"
+#include "FloorPlan.h"
+#include "MapFile.h"
+
+/**
+ * Builds the FloorPlan for the walls of a map file and prints it as C
+ * source that can be compiled into flash:
+ *
+ *   ./floorplangen workcell.map workcellPlan > workcellPlan.h
+ *
+ * declares
+ *
+ *   const uint8_t workcellPlan[] PROGMEM = { ... };
+ *   static_assert(sizeof(workcellPlan) == FLOOR_PLAN_BYTES(10, 10), ...);
+ *
+ * which is then used as FloorPlan(workcellPlan, true). The array is left
+ * unsized and checked against FLOOR_PLAN_BYTES() instead, so that the
+ * compiler rejects a table edited to be too long or too short; a sized
+ * array would quietly pad a short one with zeros.
+ */
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <map file> <array name>\n", argv[0]);
+    return 2;
+  }
+
+  MapFile file;
+  if (! file.load(argv[1])) {
+    fprintf(stderr, "%s: %s\n", argv[1], file.getError().c_str());
+    return 1;
+  }
+
+  Map map(file.getSizeX(), file.getSizeY());
+  file.fill(map);
+
+  vector<uint8_t> table(FLOOR_PLAN_BYTES(map.getSizeX(), map.getSizeY()));
+  FloorPlan::build(map, &table[0], table.size());
+
+  printf("// Generated by floorplangen from %s; do not edit\n", argv[1]);
+  printf("const uint8_t %s[] PROGMEM = {", argv[2]);
+  for (size_t i=0; i<table.size(); i++) {
+    printf("%s0x%02x", (i % 12) ? ", " : (i ? ",\n  " : "\n  "), table[i]);
+  }
+  printf("\n};\n");
+  printf("static_assert(sizeof(%s) == FLOOR_PLAN_BYTES(%u, %u), \"%s does not match its size\");\n",
+         argv[2], map.getSizeX(), map.getSizeY(), argv[2]);
+
+  return 0;
+}
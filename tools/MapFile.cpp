@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <fstream>
+#include <sstream>
+#include "Map.h"
+#include "MapFile.h"
+
+using namespace std;
+
+bool MapFile::load(const char *path) {
+  ifstream in(path);
+  if (! in) {
+    mError = string("cannot open ") + path;
+    return false;
+  }
+
+  stringstream text;
+  text << in.rdbuf();
+  return parse(text.str());
+}
+
+bool MapFile::parse(const string& text) {
+  istringstream in(text);
+  string line;
+  size_t widest = 0;
+
+  mRows.clear();
+  mError.clear();
+  while (getline(in, line)) {
+    if (! line.empty() && line[line.size() - 1] == '\r') {
+      line.erase(line.size() - 1);
+    }
+    if (! line.empty() && line[0] == ';') {
+      continue;
+    }
+    mRows.push_back(line);
+    if (line.size() > widest) {
+      widest = line.size();
+    }
+  }
+
+  // Trailing blank lines are not part of the map
+  while (! mRows.empty() && mRows.back().empty()) {
+    mRows.pop_back();
+  }
+
+  if (mRows.empty() || widest == 0) {
+    mError = "empty map";
+    return false;
+  }
+  if (mRows.size() > DEFAULT_X_SIZE || widest > DEFAULT_Y_SIZE) {
+    mError = "map larger than DEFAULT_X_SIZE x DEFAULT_Y_SIZE";
+    return false;
+  }
+
+  for (size_t x=0; x<mRows.size(); x++) {
+    for (size_t y=0; y<mRows[x].size(); y++) {
+      if (string(". #?RG").find(mRows[x][y]) == string::npos) {
+        ostringstream message;
+        message << "unexpected '" << mRows[x][y] << "' at " << x << "," << y;
+        mError = message.str();
+        return false;
+      }
+    }
+  }
+
+  mSizeY = widest;
+  return true;
+}
+
+uint8_t MapFile::getSizeX() {
+  return mRows.size();
+}
+
+uint8_t MapFile::getSizeY() {
+  return mSizeY;
+}
+
+const string& MapFile::getError() {
+  return mError;
+}
+
+void MapFile::fill(Map& map) {
+  for (uint8_t x=0; x<mRows.size(); x++) {
+    for (uint8_t y=0; y<mSizeY; y++) {
+      uint8_t value = NOTHING;
+      switch (y < mRows[x].size() ? mRows[x][y] : '.') {
+        case '#': value = WALL; break;
+        case '?': value = UNKNOWN; break;
+        case 'R': value = ROBOT; break;
+        case 'G': value = GOAL; break;
+      }
+      map.placeValue(x, y, value);
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef _MapFile_h_
+#define _MapFile_h_
+
+#include <string>
+#include <vector>
+
+/**
+ * Reads maps drawn as text, one line per X row with one character per Y
+ * column, laid out the same way as the grid diagram in Map.h:
+ *
+ *   .  or space  NOTHING
+ *   #            WALL
+ *   ?            UNKNOWN
+ *   R            ROBOT
+ *   G            GOAL
+ *
+ * Lines starting with ';' are comments. Short lines are padded with
+ * NOTHING.
+ */
+class MapFile {
+
+  public:
+
+    /**
+     * Reads the named file, returning false (with a message in
+     * getError()) if it cannot be read or does not describe a map.
+     */
+    bool load(const char *path);
+
+    /**
+     * As MapFile::load(), but reads the map from a string.
+     */
+    bool parse(const std::string& text);
+
+    uint8_t getSizeX();
+    uint8_t getSizeY();
+    const std::string& getError();
+
+    /**
+     * Places every cell of the loaded map onto the map, which must be at
+     * least getSizeX() x getSizeY() cells.
+     */
+    void fill(Map& map);
+
+  private:
+
+    std::vector<std::string> mRows;
+    uint8_t mSizeY;
+    std::string mError;
+};
+
+#endif
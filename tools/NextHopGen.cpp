@@ -0,0 +1,57 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Map.h"
+#include "CellQueue.h"
+#include "DistanceField.h"
+#include "NextHopTable.h"
+#include "MapFile.h"
+
+/**
+ * Builds the NextHopTable for a map file and prints it as C source that
+ * can be compiled into flash:
+ *
+ *   ./nexthopgen workcell.map workcellHops > workcellHops.h
+ *
+ * declares
+ *
+ *   const uint8_t workcellHops[] PROGMEM = { ... };
+ *
+ * which is then used as NextHopTable(workcellHops, true).
+ */
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <map file> <array name>\n", argv[0]);
+    return 2;
+  }
+
+  MapFile file;
+  if (! file.load(argv[1])) {
+    fprintf(stderr, "%s: %s\n", argv[1], file.getError().c_str());
+    return 1;
+  }
+
+  Map map(file.getSizeX(), file.getSizeY());
+  file.fill(map);
+
+  static CellQueue queue;
+  static DistanceField field;
+  vector<uint8_t> table(NEXT_HOP_TABLE_BYTES(map.getSizeX(), map.getSizeY()));
+  if (! NextHopTable::build(map, &table[0], table.size(), field, queue)) {
+    fprintf(stderr, "%s: more than 254 separate areas, or cells too far from a goal\n", argv[1]);
+    return 1;
+  }
+
+  printf("// Generated by nexthopgen from %s; do not edit\n", argv[1]);
+  printf("const uint8_t %s[] PROGMEM = {", argv[2]);
+  for (size_t i=0; i<table.size(); i++) {
+    printf("%s0x%02x", (i % 12) ? ", " : (i ? ",\n  " : "\n  "), table[i]);
+  }
+  printf("\n};\n");
+
+  return 0;
+}
@@ -0,0 +1,525 @@
+#include <Arduino.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Coordinate.h"
+#include "MinValueDirection.h"
+#include "IWavefront.h"
+#include "Map.h"
+#include "CellQueue.h"
+#include "CellSet.h"
+#include "DistanceField.h"
+#include "WavefrontCache.h"
+#include "Path.h"
+#include "MapFile.h"
+#include "WorkerPool.h"
+
+/**
+ * Plans a batch of scenarios across every core and reports the result
+ * of each one:
+ *
+ *   ./waveplan [options] <map file or directory>...
+ *   ./waveplan [options] --queries <query file>
+ *
+ * Without a query file every map (every *.map file in a directory) is
+ * one scenario, from its R to its G. A query file instead lists one
+ * scenario per line as
+ *
+ *   <map file> <robot x> <robot y> <goal x> <goal y>
+ *
+ * with map files relative to the query file and ';' starting a comment.
+ * Each map is loaded once and all of its queries are planned by the same
+ * thread, so the cache engine can reuse fields between them.
+ *
+ * Options:
+ *
+ *   --engine wavefront|field|cache   planner to run (default field)
+ *   --threads N                      worker threads (default all cores)
+ *   --format csv|json                output format (default csv)
+ *   --moves                          also print every move of the path
+ *
+ * Results are written to stdout in input order, with the time each plan
+ * took, CSV fields quoted where they need it; a summary goes to stderr. A length of -1 means there is no path;
+ * the error column then says why, if it is not simply that the goal
+ * cannot be reached. The wavefront engine gives up after a fixed number
+ * of sweeps over the map, so on large maps it can miss a path that is
+ * there; such rows say "iteration limit reached".
+ */
+
+using namespace std;
+
+/**
+ * One robot/goal pair on one of the loaded maps.
+ */
+struct Scenario {
+  size_t map;
+  boolean fromFile;
+  uint8_t robotX;
+  uint8_t robotY;
+  uint8_t goalX;
+  uint8_t goalY;
+};
+
+struct Result {
+  uint8_t robotX;
+  uint8_t robotY;
+  uint8_t goalX;
+  uint8_t goalY;
+  uint8_t direction;
+  int length;
+  unsigned long ns;
+  string moves;
+  string error;
+  boolean limited;
+};
+
+/**
+ * Everything a thread needs to plan, allocated once per thread since it
+ * is far too big for the stack with the tools' map storage.
+ */
+struct Worker {
+  CellQueue queue;
+  DistanceField field;
+  WavefrontCache cache;
+  Path path;
+};
+
+enum Engine { ENGINE_WAVEFRONT, ENGINE_FIELD, ENGINE_CACHE };
+
+static const char *DIRECTION_NAMES[] = { "none", "up", "right", "down", "left" };
+static const char MOVE_LETTERS[] = "-URDL";
+
+/**
+ * Escapes text for use inside a JSON string.
+ */
+static string jsonEscape(const string& text) {
+  string escaped;
+  for (size_t i=0; i<text.size(); i++) {
+    unsigned char c = text[i];
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c < 0x20) {
+      char code[8];
+      snprintf(code, sizeof(code), "\\u%04x", c);
+      escaped += code;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * Quotes text for a CSV field if it holds a comma, a quote or a line
+ * break, doubling any quotes inside.
+ */
+static string csvField(const string& text) {
+  if (text.find_first_of(",\"\r\n") == string::npos) {
+    return text;
+  }
+  string quoted = "\"";
+  for (size_t i=0; i<text.size(); i++) {
+    if (text[i] == '"') {
+      quoted += '"';
+    }
+    quoted += text[i];
+  }
+  return quoted + "\"";
+}
+
+static bool endsWith(const string& text, const string& suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Adds the map files named on the command line, expanding directories
+ * to the *.map files inside them in name order.
+ */
+static bool addMapFiles(const char *path, vector<string>& files) {
+  DIR *dir = opendir(path);
+  if (dir == NULL) {
+    files.push_back(path);
+    return true;
+  }
+
+  vector<string> names;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (endsWith(entry->d_name, ".map")) {
+      names.push_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+
+  sort(names.begin(), names.end());
+  for (size_t i=0; i<names.size(); i++) {
+    files.push_back(string(path) + "/" + names[i]);
+  }
+  return true;
+}
+
+static bool readQueries(const char *path,
+                        vector<string>& files,
+                        vector<Scenario>& scenarios) {
+  ifstream in(path);
+  if (! in) {
+    fprintf(stderr, "%s: cannot open\n", path);
+    return false;
+  }
+
+  string base(path);
+  size_t slash = base.rfind('/');
+  base = slash == string::npos ? "" : base.substr(0, slash + 1);
+
+  std::map<string, size_t> known;
+  string line;
+  for (unsigned number=1; getline(in, line); number++) {
+    if (line.empty() || line[0] == ';' || line.find_first_not_of(" \t\r") == string::npos) {
+      continue;
+    }
+
+    istringstream fields(line);
+    string file;
+    unsigned robotX, robotY, goalX, goalY;
+    if (! (fields >> file >> robotX >> robotY >> goalX >> goalY) ||
+        robotX > 0xff || robotY > 0xff || goalX > 0xff || goalY > 0xff) {
+      fprintf(stderr, "%s:%u: expected <map> <robot x> <robot y> <goal x> <goal y>\n",
+              path, number);
+      return false;
+    }
+
+    if (file[0] != '/') {
+      file = base + file;
+    }
+    if (known.find(file) == known.end()) {
+      known[file] = files.size();
+      files.push_back(file);
+    }
+
+    Scenario scenario = { known[file], false,
+                          (uint8_t)robotX, (uint8_t)robotY,
+                          (uint8_t)goalX, (uint8_t)goalY };
+    scenarios.push_back(scenario);
+  }
+  return true;
+}
+
+/**
+ * Returns true for the cells every engine treats as impassable.
+ */
+static bool blocked(uint8_t value) {
+  return value == WALL || value == UNKNOWN;
+}
+
+/**
+ * Places the scenario's robot and goal on a freshly filled map, in place
+ * of any the map file drew.
+ */
+static void placeEnds(Map& map, const Scenario& scenario) {
+  Coordinate found;
+  if (map.locateRobot(found) && map.getValue(found.getX(), found.getY()) == ROBOT) {
+    map.placeValue(found.getX(), found.getY(), NOTHING);
+  }
+  if (map.locateGoal(found) && map.getValue(found.getX(), found.getY()) == GOAL) {
+    map.placeValue(found.getX(), found.getY(), NOTHING);
+  }
+  map.placeValue(scenario.goalX, scenario.goalY, GOAL);
+  map.placeValue(scenario.robotX, scenario.robotY, ROBOT);
+}
+
+/**
+ * Spells out the moves down a propagated map from the robot to the goal.
+ * Every labelled cell has a neighbour with a lower label, so this always
+ * ends on the goal.
+ */
+static void wavefrontMoves(Map& map, const Result& result, string& moves) {
+  uint8_t x = result.robotX;
+  uint8_t y = result.robotY;
+  uint32_t cells = (uint32_t)map.getSizeX() * map.getSizeY();
+  while (map.getValue(x, y) != GOAL && moves.size() < cells) {
+    MinValueDirection mvd(RESET_MIN, NOTHING);
+    map.minSurroundingNode(x, y, mvd);
+    switch (mvd.getDirection()) {
+      case DOWN: x++; break;
+      case UP: x--; break;
+      case RIGHT: y++; break;
+      case LEFT: y--; break;
+      default: return;
+    }
+    moves += MOVE_LETTERS[mvd.getDirection()];
+  }
+}
+
+static void plan(Engine engine,
+                 Worker& worker,
+                 MapFile& file,
+                 Map& map,
+                 const Scenario& scenario,
+                 boolean moves,
+                 Result& result) {
+  result.robotX = scenario.robotX;
+  result.robotY = scenario.robotY;
+  result.goalX = scenario.goalX;
+  result.goalY = scenario.goalY;
+  result.direction = NOTHING;
+  result.length = -1;
+  result.ns = 0;
+  result.limited = false;
+
+  if (! map.coordinateInRange(result.robotX, result.robotY) ||
+      ! map.coordinateInRange(result.goalX, result.goalY)) {
+    result.error = "no robot or goal on the map";
+    return;
+  }
+  if (blocked(map.getValue(result.robotX, result.robotY)) ||
+      blocked(map.getValue(result.goalX, result.goalY))) {
+    result.error = "robot or goal on a blocked cell";
+    return;
+  }
+
+  chrono::steady_clock::time_point start;
+  if (engine == ENGINE_WAVEFRONT) {
+    // Propagation writes into the map, so every query starts afresh
+    file.fill(map);
+    if (! scenario.fromFile) {
+      placeEnds(map, scenario);
+    }
+
+    start = chrono::steady_clock::now();
+    result.direction = map.propagateWavefront(NULL);
+    if (result.direction != NOTHING) {
+      MinValueDirection mvd(RESET_MIN, NOTHING);
+      map.minSurroundingNode(result.robotX, result.robotY, mvd);
+      result.length = mvd.getNodeValue();
+    } else if (result.robotX == result.goalX && result.robotY == result.goalY) {
+      result.length = 0;
+    }
+  } else {
+    start = chrono::steady_clock::now();
+    DistanceField *field = &worker.field;
+    if (engine == ENGINE_CACHE) {
+      field = &worker.cache.lookup(map, result.goalX, result.goalY);
+    } else {
+      field->compute(map, result.goalX, result.goalY, worker.queue);
+    }
+    if (worker.path.extract(*field, result.robotX, result.robotY)) {
+      result.direction = worker.path.getDirection(0);
+      result.length = worker.path.getLength();
+    }
+  }
+  result.ns = chrono::duration_cast<chrono::nanoseconds>(
+      chrono::steady_clock::now() - start).count();
+
+  // Neither telling the reason apart nor spelling out the moves is part
+  // of the plan's time
+  if (engine == ENGINE_WAVEFRONT && result.length < 0) {
+    worker.field.computeUntil(map, result.goalX, result.goalY, worker.queue,
+                              result.robotX, result.robotY);
+    if (worker.field.directionFrom(result.robotX, result.robotY) != NOTHING) {
+      result.limited = true;
+      result.error = "iteration limit reached";
+    }
+  }
+  if (moves && result.length > 0) {
+    if (engine == ENGINE_WAVEFRONT) {
+      wavefrontMoves(map, result, result.moves);
+    } else {
+      for (uint16_t i=0; i<worker.path.getLength(); i++) {
+        result.moves += MOVE_LETTERS[worker.path.getDirection(i)];
+      }
+    }
+  }
+}
+
+static void printResult(const string& file, const Result& result, boolean json, boolean moves) {
+  if (json) {
+    printf("{\"map\":\"%s\",\"robot\":[%u,%u],\"goal\":[%u,%u],"
+           "\"direction\":\"%s\",\"length\":%d,\"ns\":%lu",
+           jsonEscape(file).c_str(), result.robotX, result.robotY, result.goalX, result.goalY,
+           DIRECTION_NAMES[result.direction], result.length, result.ns);
+    if (moves) {
+      printf(",\"moves\":\"%s\"", result.moves.c_str());
+    }
+    if (! result.error.empty()) {
+      printf(",\"error\":\"%s\"", jsonEscape(result.error).c_str());
+    }
+    printf("}\n");
+  } else {
+    printf("%s,%u,%u,%u,%u,%s,%d,%lu",
+           csvField(file).c_str(), result.robotX, result.robotY, result.goalX, result.goalY,
+           DIRECTION_NAMES[result.direction], result.length, result.ns);
+    if (moves) {
+      printf(",%s", result.moves.c_str());
+    }
+    printf(",%s\n", csvField(result.error).c_str());
+  }
+}
+
+static int usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s [--engine wavefront|field|cache] [--threads N] [--format csv|json]\n"
+          "          [--moves] (--queries <file> | <map file or directory>...)\n",
+          name);
+  return 2;
+}
+
+int main(int argc, char* argv[]) {
+  Engine engine = ENGINE_FIELD;
+  unsigned threads = 0;
+  boolean json = false;
+  boolean moves = false;
+  const char *queries = NULL;
+  vector<string> files;
+  vector<Scenario> scenarios;
+
+  for (int i=1; i<argc; i++) {
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (strcmp(argv[i], "--engine") == 0 && value) {
+      if (strcmp(value, "wavefront") == 0) {
+        engine = ENGINE_WAVEFRONT;
+      } else if (strcmp(value, "field") == 0) {
+        engine = ENGINE_FIELD;
+      } else if (strcmp(value, "cache") == 0) {
+        engine = ENGINE_CACHE;
+      } else {
+        return usage(argv[0]);
+      }
+      i++;
+    } else if (strcmp(argv[i], "--threads") == 0 && value) {
+      threads = strtoul(value, NULL, 10);
+      i++;
+    } else if (strcmp(argv[i], "--format") == 0 && value) {
+      if (strcmp(value, "json") != 0 && strcmp(value, "csv") != 0) {
+        return usage(argv[0]);
+      }
+      json = strcmp(value, "json") == 0;
+      i++;
+    } else if (strcmp(argv[i], "--moves") == 0) {
+      moves = true;
+    } else if (strcmp(argv[i], "--queries") == 0 && value) {
+      queries = value;
+      i++;
+    } else if (argv[i][0] == '-') {
+      return usage(argv[0]);
+    } else {
+      addMapFiles(argv[i], files);
+    }
+  }
+
+  if (queries != NULL) {
+    if (! files.empty()) {
+      return usage(argv[0]);
+    }
+    if (! readQueries(queries, files, scenarios)) {
+      return 1;
+    }
+  } else {
+    for (size_t i=0; i<files.size(); i++) {
+      Scenario scenario = { i, true, 0xff, 0xff, 0xff, 0xff };
+      scenarios.push_back(scenario);
+    }
+  }
+  if (files.empty()) {
+    return usage(argv[0]);
+  }
+
+  // Scenarios grouped by map, so that a job is one map and its queries
+  vector<vector<size_t> > byMap(files.size());
+  for (size_t i=0; i<scenarios.size(); i++) {
+    byMap[scenarios[i].map].push_back(i);
+  }
+
+  WorkerPool pool(threads);
+  vector<Worker *> workers(pool.getThreads());
+  for (size_t i=0; i<workers.size(); i++) {
+    workers[i] = new Worker();
+  }
+  vector<Result> results(scenarios.size());
+  vector<string> errors(files.size());
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  pool.run(files.size(), [&](unsigned w, size_t m) {
+    MapFile file;
+    if (! file.load(files[m].c_str())) {
+      errors[m] = file.getError();
+      return;
+    }
+
+    Worker& worker = *workers[w];
+    Map *map = new Map(file.getSizeX(), file.getSizeY());
+    file.fill(*map);
+
+    // Fields cached for another map must not be mistaken for this one's
+    worker.cache.invalidate();
+
+    for (size_t i=0; i<byMap[m].size(); i++) {
+      Scenario scenario = scenarios[byMap[m][i]];
+      if (scenario.fromFile) {
+        Coordinate robot;
+        Coordinate goal;
+        if (map->locateRobot(robot) && map->locateGoal(goal)) {
+          scenario.robotX = robot.getX();
+          scenario.robotY = robot.getY();
+          scenario.goalX = goal.getX();
+          scenario.goalY = goal.getY();
+        }
+      }
+      plan(engine, worker, file, *map, scenario, moves, results[byMap[m][i]]);
+    }
+    delete map;
+  });
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  size_t failed = 0;
+  for (size_t m=0; m<files.size(); m++) {
+    if (! errors[m].empty()) {
+      fprintf(stderr, "%s: %s\n", files[m].c_str(), errors[m].c_str());
+      failed += byMap[m].size();
+    }
+  }
+
+  size_t unreachable = 0;
+  size_t limited = 0;
+  size_t rejected = 0;
+  if (! json) {
+    printf("map,robot_x,robot_y,goal_x,goal_y,direction,length,ns%s,error\n",
+           moves ? ",moves" : "");
+  }
+  for (size_t i=0; i<scenarios.size(); i++) {
+    if (! errors[scenarios[i].map].empty()) {
+      continue;
+    }
+    printResult(files[scenarios[i].map], results[i], json, moves);
+    if (results[i].limited) {
+      limited++;
+    } else if (! results[i].error.empty()) {
+      rejected++;
+    } else if (results[i].length < 0) {
+      unreachable++;
+    }
+  }
+
+  fprintf(stderr, "%lu scenarios on %u threads in %.3f s (%.0f plans/s), "
+          "%lu without a path, %lu at the iteration limit, %lu rejected, "
+          "%lu on unreadable maps\n",
+          (unsigned long)scenarios.size(), pool.getThreads(), seconds,
+          seconds > 0 ? scenarios.size() / seconds : 0.0,
+          (unsigned long)unreachable, (unsigned long)limited, (unsigned long)rejected,
+          (unsigned long)failed);
+
+  for (size_t i=0; i<workers.size(); i++) {
+    delete workers[i];
+  }
+  return failed ? 1 : 0;
+}
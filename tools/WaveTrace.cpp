@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "IWavefront.h"
+#include "Map.h"
+#include "WavefrontTrace.h"
+#include "WavefrontTraceReader.h"
+#include "MapFile.h"
+
+/**
+ * Records and replays wavefront traces:
+ *
+ *   ./wavetrace record <map file> <trace file>
+ *   ./wavetrace play [--summary | --final] <trace file>
+ *
+ * record propagates the map from its R to its G with a WavefrontTrace
+ * attached and writes the trace out. play draws the map after every
+ * step the same way the test suite's WaveFrontFormatter does, or with
+ * --final only after the last one; --summary prints one line per step
+ * with the number of cells relabeled instead.
+ */
+
+using namespace std;
+
+static int record(const char *mapPath, const char *tracePath) {
+  MapFile file;
+  if (! file.load(mapPath)) {
+    fprintf(stderr, "%s: %s\n", mapPath, file.getError().c_str());
+    return 1;
+  }
+
+  Map *map = new Map(file.getSizeX(), file.getSizeY());
+  file.fill(*map);
+
+  // Start small and grow until the whole propagation fits
+  vector<uint8_t> buffer(1 << 16);
+  uint8_t direction;
+  for (;;) {
+    WavefrontTrace trace(&buffer[0], buffer.size());
+    direction = map->propagateWavefront(&trace);
+    if (! trace.getOverflow()) {
+      buffer.resize(trace.getLength());
+      fprintf(stderr, "%u steps in %lu bytes, direction %u\n",
+              trace.getSteps(), (unsigned long)trace.getLength(), direction);
+      break;
+    }
+    buffer.resize(buffer.size() * 2);
+  }
+  delete map;
+
+  FILE *out = fopen(tracePath, "wb");
+  if (out == NULL || fwrite(&buffer[0], 1, buffer.size(), out) != buffer.size()) {
+    fprintf(stderr, "%s: cannot write\n", tracePath);
+    return 1;
+  }
+  fclose(out);
+  return 0;
+}
+
+static void printCell(uint8_t value) {
+  switch (value) {
+    case NOTHING: printf("   "); break;
+    case ROBOT: printf(" R "); break;
+    case GOAL: printf(" G "); break;
+    case WALL: printf(" W "); break;
+    case UNKNOWN: printf(" ? "); break;
+    default: printf("%03d", value); break;
+  }
+}
+
+static void draw(vector<uint8_t>& grid, uint8_t sizeX, uint8_t sizeY) {
+  for (uint8_t x=0; x<sizeX; x++) {
+    for (uint8_t y=0; y<sizeY; y++) {
+      printCell(grid[x * sizeY + y]);
+      printf(" ");
+    }
+    printf("\n");
+  }
+  printf("\n");
+}
+
+static int play(const char *tracePath, boolean summary, boolean final) {
+  FILE *in = fopen(tracePath, "rb");
+  if (in == NULL) {
+    fprintf(stderr, "%s: cannot open\n", tracePath);
+    return 1;
+  }
+  vector<uint8_t> buffer;
+  uint8_t chunk[4096];
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    buffer.insert(buffer.end(), chunk, chunk + got);
+  }
+  fclose(in);
+
+  WavefrontTraceReader reader(buffer.empty() ? NULL : &buffer[0], buffer.size());
+  if (! reader.isValid()) {
+    fprintf(stderr, "%s: not a wavefront trace\n", tracePath);
+    return 1;
+  }
+
+  uint8_t sizeX = reader.getSizeX();
+  uint8_t sizeY = reader.getSizeY();
+  vector<uint8_t> grid(sizeX * sizeY, NOTHING);
+  uint8_t x, y, value;
+  for (unsigned step=0; ! reader.atEnd(); step++) {
+    unsigned cells = 0;
+    while (reader.nextCell(x, y, value)) {
+      grid[x * sizeY + y] = value;
+      cells++;
+    }
+    if (summary) {
+      printf("step %u: %u cells\n", step, cells);
+    } else if (! final) {
+      printf("step %u:\n", step);
+      draw(grid, sizeX, sizeY);
+    }
+  }
+  if (! reader.isValid()) {
+    fprintf(stderr, "%s: trace is cut short\n", tracePath);
+    return 1;
+  }
+  if (final) {
+    draw(grid, sizeX, sizeY);
+  }
+  return 0;
+}
+
+static int usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s record <map file> <trace file>\n"
+          "       %s play [--summary | --final] <trace file>\n",
+          name, name);
+  return 2;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc == 4 && strcmp(argv[1], "record") == 0) {
+    return record(argv[2], argv[3]);
+  }
+  if (argc == 3 && strcmp(argv[1], "play") == 0) {
+    return play(argv[2], false, false);
+  }
+  if (argc == 4 && strcmp(argv[1], "play") == 0) {
+    if (strcmp(argv[2], "--summary") == 0) {
+      return play(argv[3], true, false);
+    }
+    if (strcmp(argv[2], "--final") == 0) {
+      return play(argv[3], false, true);
+    }
+  }
+  return usage(argv[0]);
+}
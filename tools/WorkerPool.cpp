@@ -0,0 +1,36 @@
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "WorkerPool.h"
+
+using namespace std;
+
+WorkerPool::WorkerPool(unsigned threads) {
+  mThreads = threads ? threads : thread::hardware_concurrency();
+  if (mThreads == 0) {
+    mThreads = 1;
+  }
+}
+
+unsigned WorkerPool::getThreads() {
+  return mThreads;
+}
+
+void WorkerPool::run(size_t count, const function<void(unsigned, size_t)>& job) {
+  atomic<size_t> next(0);
+  unsigned threads = count < mThreads ? count : mThreads;
+
+  vector<thread> workers;
+  for (unsigned worker=0; worker<threads; worker++) {
+    workers.push_back(thread([&, worker]() {
+      for (size_t index=next++; index<count; index=next++) {
+        job(worker, index);
+      }
+    }));
+  }
+
+  for (size_t i=0; i<workers.size(); i++) {
+    workers[i].join();
+  }
+}
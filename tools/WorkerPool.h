@@ -0,0 +1,36 @@
+#ifndef _WorkerPool_h_
+#define _WorkerPool_h_
+
+#include <functional>
+
+/**
+ * Runs a numbered batch of independent jobs across a fixed number of
+ * threads. Each thread claims the next unclaimed job from a shared
+ * counter, so long and short jobs even out without any up-front split.
+ */
+class WorkerPool {
+
+  public:
+
+    /**
+     * Constructs a pool of the given number of threads; zero means one
+     * per hardware thread.
+     */
+    WorkerPool(unsigned threads);
+
+    unsigned getThreads();
+
+    /**
+     * Calls job(worker, index) once for every index below count and
+     * returns when all of them are done. worker is below getThreads()
+     * and no two threads share one at the same time, so it can select
+     * per-thread planner state.
+     */
+    void run(size_t count, const std::function<void(unsigned, size_t)>& job);
+
+  private:
+
+    unsigned mThreads;
+};
+
+#endif